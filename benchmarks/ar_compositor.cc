@@ -0,0 +1,365 @@
+// Composición AR fuera de línea de una sesión grabada (--record / --input) con su
+// pista de poses (--pose-log, p. ej. de --headless). Sin pista, cada proceso
+// recalcula la pose con ArUco + solvePnP como la aplicación.
+//
+//   ar_compositor <video> <salida.mjpeg> [--poses poses.csv] [--workers n] [--model obj]
+//                 [--mtl-dir dir] [--calibration f.yml] [--quality q] [--composite fillrate|legacy]
+//
+// El video se reparte en tantos tramos contiguos como procesos; cada proceso abre su
+// propio contexto oculto (GLFW solo crea ventanas en el hilo principal, así que son
+// procesos y no hilos), salta al inicio de su tramo, compone en un FBO y escribe su
+// segmento MJPEG. Al final se concatenan los segmentos en orden, y el resultado se
+// reproduce con --input. El informe da los fotogramas por segundo totales y por
+// proceso, y el coste de cada etapa, para dimensionar los nodos de render.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ARRenderer.h>
+#include <AsyncFileWriter.h>
+#include <FrameRecorder.h>
+#include <JpegFrameSource.h>
+#include <PerfStats.h>
+#include <VisionPipeline.h>
+
+struct CompositorOptions {
+  std::string inputPath, outputPath, posePath;
+  std::string objPath = "../../rata-centrada.obj";
+  std::string mtlBasePath = "../../";
+  std::string calibrationPath = "calibration_data.yml";
+  int workers = 0; // 0 = núcleos disponibles
+  int quality = 85;
+  CompositeMode compositeMode = CompositeMode::FillRate;
+};
+
+struct PoseSample {
+  bool found = false;
+  cv::Vec3d rvec, tvec;
+};
+
+// Lo que cada proceso devuelve al padre por su tubería.
+struct SliceReport {
+  long long frames = 0;
+  double setupMs = 0.0; // contexto, FBO y modelo
+  double wallMs = 0.0;  // bucle de fotogramas
+  double readMs = 0.0, poseMs = 0.0, renderMs = 0.0, encodeMs = 0.0;
+  bool ok = false;
+};
+
+static const float markerLength_m = 0.05f;
+
+// Formato de PoseLog: frame,timestamp_us,found,rx,ry,rz,tx,ty,tz.
+static bool readPoseTrack(const std::string &path, std::vector<PoseSample> &track) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Error: No se pudo abrir la pista de poses " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  std::getline(file, line); // cabecera
+  while (std::getline(file, line)) {
+    long long frame = 0, timestampUs = 0;
+    int found = 0;
+    PoseSample sample;
+    if (std::sscanf(line.c_str(), "%lld,%lld,%d,%lf,%lf,%lf,%lf,%lf,%lf", &frame, &timestampUs, &found,
+                    &sample.rvec[0], &sample.rvec[1], &sample.rvec[2], &sample.tvec[0], &sample.tvec[1],
+                    &sample.tvec[2]) != 9 || frame < 0)
+      continue;
+    sample.found = found != 0;
+    if ((size_t)frame >= track.size()) track.resize((size_t)frame + 1);
+    track[(size_t)frame] = sample;
+  }
+  return true;
+}
+
+// Lee la grabación a partir de un fotograma: las entradas JPEG avanzan sin
+// decodificar y los demás contenedores saltan con CAP_PROP_POS_FRAMES (FFmpeg busca
+// el keyframe anterior y decodifica hasta el pedido).
+class SliceReader {
+public:
+  SliceReader(const std::string &path, long long begin) {
+    jpeg = JpegFrameSource::open(path, 1);
+    if (jpeg) {
+      for (long long i = 0; i < begin && jpeg->skip(); ++i) {
+      }
+      return;
+    }
+    video.open(path);
+    if (video.isOpened() && begin > 0)
+      video.set(cv::CAP_PROP_POS_FRAMES, (double)begin);
+  }
+
+  bool isOpened() const { return jpeg ? jpeg->isOpened() : video.isOpened(); }
+  bool read(cv::Mat &frame) { return jpeg ? jpeg->read(frame) : video.read(frame); }
+
+private:
+  std::unique_ptr<JpegFrameSource> jpeg;
+  cv::VideoCapture video;
+};
+
+// Exacto para entradas JPEG (se recorren sin decodificar); en otros contenedores
+// CAP_PROP_FRAME_COUNT es aproximado, así que el último tramo lee hasta el final.
+static long long countFrames(const std::string &path) {
+  if (auto jpeg = JpegFrameSource::open(path, 1)) {
+    long long frames = 0;
+    while (jpeg->skip())
+      frames++;
+    return frames;
+  }
+  cv::VideoCapture video(path);
+  return video.isOpened() ? (long long)video.get(cv::CAP_PROP_FRAME_COUNT) : -1;
+}
+
+// Proceso hijo: compone [begin, end) en segmentPath.
+static SliceReport renderSlice(const CompositorOptions &options, const std::vector<PoseSample> &track,
+                               long long begin, long long end, const std::string &segmentPath) {
+  SliceReport report;
+  const auto setupStart = std::chrono::steady_clock::now();
+  SliceReader reader(options.inputPath, begin);
+  cv::Mat frame;
+  if (!reader.isOpened() || !reader.read(frame)) {
+    report.ok = true; // tramo vacío (el recuento del contenedor era aproximado)
+    return report;
+  }
+
+  ARObjectRenderer renderer;
+  if (!renderer.init(frame.cols, frame.rows, "ar_compositor", false) || !renderer.setOffscreenOutput(true) ||
+      !renderer.loadModel(options.objPath, options.mtlBasePath)) {
+    std::cerr << "Error: No se pudo preparar el renderizador fuera de pantalla." << std::endl;
+    return report;
+  }
+  renderer.setCompositeMode(options.compositeMode);
+
+  cv::Mat cameraMatrix, distCoeffs;
+  cv::FileStorage fs(options.calibrationPath, cv::FileStorage::READ);
+  if (fs.isOpened()) {
+    fs["cameraMatrix"] >> cameraMatrix;
+    fs["distCoeffs"] >> distCoeffs;
+  }
+  if (cameraMatrix.empty()) {
+    // Los mismos intrínsecos aproximados que la aplicación sin calibración.
+    cameraMatrix = (cv::Mat_<double>(3, 3) << frame.cols, 0, frame.cols / 2.0, 0, frame.cols, frame.rows / 2.0,
+                    0, 0, 1);
+    distCoeffs = cv::Mat::zeros(1, 5, CV_64F);
+  }
+
+  const cv::aruco::ArucoDetector detector(cv::aruco::getPredefinedDictionary(cv::aruco::DICT_6X6_250));
+  ArucoDetectorStage detectorStage{&detector};
+  PnPPoseStage poseStage(&cameraMatrix, &distCoeffs, markerLength_m);
+  VisionFrame vision;
+
+  AsyncFileWriter fileWriter;
+  MjpegRecorder recorder(fileWriter, segmentPath, options.quality);
+  if (!recorder.isOpened()) return report;
+  report.setupMs = elapsedMs(setupStart);
+
+  const auto loopStart = std::chrono::steady_clock::now();
+  for (long long index = begin; index < end; ++index) {
+    auto stageStart = std::chrono::steady_clock::now();
+    if (index > begin && !reader.read(frame))
+      break;
+    report.readMs += elapsedMs(stageStart);
+
+    // Sin marcador la pose es cero, como en VisionPipeline::process, y el modelo no
+    // se dibuja: cada fotograma depende solo de sí mismo y los tramos son independientes.
+    stageStart = std::chrono::steady_clock::now();
+    cv::Vec3d rvec(0, 0, 0), tvec(0, 0, 0);
+    if (!options.posePath.empty()) {
+      if ((size_t)index < track.size() && track[(size_t)index].found) {
+        rvec = track[(size_t)index].rvec;
+        tvec = track[(size_t)index].tvec;
+      }
+    } else {
+      vision.image = frame;
+      vision.scale = 1.0;
+      detectorStage.detect(vision);
+      if (vision.markerFound) {
+        poseStage.solve(vision);
+        rvec = vision.rvec;
+        tvec = vision.tvec;
+      }
+    }
+    report.poseMs += elapsedMs(stageStart);
+
+    // readOutput() espera a que la GPU termine: el render incluye la lectura.
+    stageStart = std::chrono::steady_clock::now();
+    renderer.render(frame, rvec, tvec, cameraMatrix);
+    const cv::Mat composite = renderer.readOutput();
+    report.renderMs += elapsedMs(stageStart);
+
+    stageStart = std::chrono::steady_clock::now();
+    if (!recorder.write(composite))
+      return report;
+    report.encodeMs += elapsedMs(stageStart);
+    report.frames++;
+  }
+  report.wallMs = elapsedMs(loopStart);
+  report.ok = true;
+  return report;
+}
+
+static bool appendFile(std::ofstream &out, const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return false;
+  if (in.peek() != std::ifstream::traits_type::eof())
+    out << in.rdbuf();
+  return out.good();
+}
+
+int main(int argc, char **argv) {
+  CompositorOptions options;
+  bool usage = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--poses") {
+      options.posePath = argv[++i];
+    } else if (i + 1 < argc && arg == "--workers") {
+      options.workers = std::max(0, std::stoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "--model") {
+      options.objPath = argv[++i];
+    } else if (i + 1 < argc && arg == "--mtl-dir") {
+      options.mtlBasePath = argv[++i];
+    } else if (i + 1 < argc && arg == "--calibration") {
+      options.calibrationPath = argv[++i];
+    } else if (i + 1 < argc && arg == "--quality") {
+      options.quality = std::clamp(std::stoi(argv[++i]), 1, 100);
+    } else if (i + 1 < argc && arg == "--composite") {
+      const std::string mode = argv[++i];
+      if (mode == "legacy") {
+        options.compositeMode = CompositeMode::Legacy;
+      } else if (mode != "fillrate") {
+        usage = true;
+      }
+    } else if (options.inputPath.empty()) {
+      options.inputPath = arg;
+    } else if (options.outputPath.empty()) {
+      options.outputPath = arg;
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || options.inputPath.empty() || options.outputPath.empty()) {
+    std::cerr << "Uso: " << argv[0]
+              << " <video> <salida.mjpeg> [--poses poses.csv] [--workers n] [--model obj] [--mtl-dir dir]"
+                 " [--calibration f.yml] [--quality q] [--composite fillrate|legacy]"
+              << std::endl;
+    return -1;
+  }
+
+  const auto batchStart = std::chrono::steady_clock::now();
+  std::vector<PoseSample> track;
+  if (!options.posePath.empty() && !readPoseTrack(options.posePath, track))
+    return 1;
+  long long frameCount = countFrames(options.inputPath);
+  if (frameCount <= 0 && !track.empty())
+    frameCount = (long long)track.size();
+  if (frameCount <= 0) {
+    std::cerr << "Error: No se pudo leer el video " << options.inputPath << std::endl;
+    return 1;
+  }
+
+  int workers = options.workers > 0 ? options.workers : (int)std::max(1u, std::thread::hardware_concurrency());
+  workers = (int)std::min<long long>(workers, frameCount);
+  const long long sliceFrames = (frameCount + workers - 1) / workers;
+  std::cout << "Composición de " << options.inputPath << ": ~" << frameCount << " fotogramas en " << workers
+            << " procesos de " << sliceFrames << ", poses "
+            << (options.posePath.empty() ? "recalculadas" : "de " + options.posePath) << std::endl;
+
+  struct Worker {
+    pid_t pid = -1;
+    int pipe = -1;
+    std::string segmentPath;
+    SliceReport report;
+  };
+  std::vector<Worker> children(workers);
+  // Sin nada pendiente en los búferes de salida, que los hijos heredarían.
+  std::cout.flush();
+  std::cerr.flush();
+  for (int w = 0; w < workers; ++w) {
+    Worker &child = children[w];
+    child.segmentPath = options.outputPath + ".part" + std::to_string(w);
+    const long long begin = w * sliceFrames;
+    const long long end = w + 1 == workers ? LLONG_MAX : begin + sliceFrames;
+    int fds[2];
+    if (::pipe(fds) != 0) {
+      std::perror("pipe");
+      return 1;
+    }
+    child.pid = fork();
+    if (child.pid < 0) {
+      std::perror("fork");
+      return 1;
+    }
+    if (child.pid == 0) {
+      ::close(fds[0]);
+      const SliceReport report = renderSlice(options, track, begin, end, child.segmentPath);
+      const bool sent = ::write(fds[1], &report, sizeof(report)) == (ssize_t)sizeof(report);
+      ::close(fds[1]);
+      std::cout.flush();
+      _exit(report.ok && sent ? 0 : 1);
+    }
+    ::close(fds[1]);
+    child.pipe = fds[0];
+  }
+
+  int failures = 0;
+  for (Worker &child : children) {
+    const bool received = ::read(child.pipe, &child.report, sizeof(child.report)) == (ssize_t)sizeof(child.report);
+    ::close(child.pipe);
+    int status = 0;
+    waitpid(child.pid, &status, 0);
+    if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !child.report.ok)
+      failures++;
+  }
+  if (failures) {
+    std::cerr << "Error: " << failures << " proceso(s) de composición fallaron." << std::endl;
+    for (const Worker &child : children)
+      std::remove(child.segmentPath.c_str());
+    return 1;
+  }
+
+  std::ofstream out(options.outputPath, std::ios::binary | std::ios::trunc);
+  for (const Worker &child : children) {
+    if (!appendFile(out, child.segmentPath)) {
+      std::cerr << "Error: No se pudo unir el segmento " << child.segmentPath << std::endl;
+      return 1;
+    }
+    std::remove(child.segmentPath.c_str());
+  }
+  out.close();
+  const double batchSeconds = elapsedMs(batchStart) / 1000.0;
+
+  long long frames = 0;
+  SliceReport total;
+  for (int w = 0; w < workers; ++w) {
+    const SliceReport &r = children[w].report;
+    frames += r.frames;
+    total.readMs += r.readMs;
+    total.poseMs += r.poseMs;
+    total.renderMs += r.renderMs;
+    total.encodeMs += r.encodeMs;
+    std::cout << "  proceso " << w << ": " << r.frames << " fotogramas, "
+              << (r.wallMs > 0 ? r.frames * 1000.0 / r.wallMs : 0.0) << " fps, preparación " << r.setupMs << " ms"
+              << std::endl;
+  }
+  const double perFrame = 1.0 / (double)std::max(1LL, frames);
+  std::cout << "Por fotograma: lectura " << total.readMs * perFrame << " ms, pose " << total.poseMs * perFrame
+            << " ms, render y lectura del FBO " << total.renderMs * perFrame << " ms, JPEG "
+            << total.encodeMs * perFrame << " ms" << std::endl;
+  std::cout << "Salida " << options.outputPath << ": " << frames << " fotogramas en " << batchSeconds << " s ("
+            << (batchSeconds > 0 ? frames / batchSeconds : 0.0) << " fps con " << workers << " procesos)"
+            << std::endl;
+  return 0;
+}
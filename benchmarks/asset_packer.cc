@@ -0,0 +1,192 @@
+// Genera el paquete de modelos (AssetPack.h) a partir del manifiesto de --assets:
+// parsea cada OBJ una sola vez, comprime su textura a S3TC con todos sus mips y lo
+// escribe ya listo para subir, junto con la asignación de marcadores.
+//
+//   asset_packer <manifiesto> <salida.pack> [--texture-cache dir]
+//
+// Al terminar abre el paquete como lo hará la aplicación y compara su coste con el
+// del parseo de los OBJ.
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ARRenderer.h>
+#include <AssetManager.h>
+#include <AssetPack.h>
+#include <PerfStats.h>
+#include <TextureCache.h>
+
+// Escritura secuencial que sabe en qué desplazamiento va y rellena con ceros.
+class PackWriter {
+public:
+    explicit PackWriter(const std::string& path) : out(path, std::ios::binary | std::ios::trunc) {}
+
+    bool good() const { return out.good(); }
+    uint64_t tell() const { return offset; }
+
+    void put(const void* data, size_t bytes) {
+        out.write(static_cast<const char*>(data), (std::streamsize)bytes);
+        offset += bytes;
+    }
+
+    uint64_t align(uint64_t alignment) {
+        static const char zeros[AssetPack::pageAlignment] = {};
+        const uint64_t aligned = AssetPack::alignUp(offset, alignment);
+        put(zeros, aligned - offset);
+        return offset;
+    }
+
+    bool rewriteHeader(const AssetPackHeader& header) {
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.flush();
+        return out.good();
+    }
+
+private:
+    std::ofstream out;
+    uint64_t offset = 0;
+};
+
+int main(int argc, char** argv) {
+    std::string manifestPath, packPath, textureCacheDir = ".texcache";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--texture-cache") {
+            textureCacheDir = argv[++i];
+        } else if (manifestPath.empty()) {
+            manifestPath = arg;
+        } else if (packPath.empty()) {
+            packPath = arg;
+        } else {
+            manifestPath.clear();
+            break;
+        }
+    }
+    if (manifestPath.empty() || packPath.empty()) {
+        std::cerr << "Uso: " << argv[0] << " <manifiesto> <salida.pack> [--texture-cache dir]" << std::endl;
+        return -1;
+    }
+
+    std::vector<AssetManifestEntry> manifest;
+    if (!readAssetManifest(manifestPath, manifest) || manifest.empty()) {
+        std::cerr << "Error: Manifiesto vacío o inválido: " << manifestPath << std::endl;
+        return 1;
+    }
+
+    PackWriter writer(packPath);
+    if (!writer.good()) {
+        std::cerr << "Error: No se pudo crear " << packPath << std::endl;
+        return 1;
+    }
+    AssetPackHeader header{};
+    std::memcpy(header.magic, AssetPack::magic, sizeof(header.magic));
+    header.version = AssetPack::version;
+    writer.put(&header, sizeof(header));
+
+    const TextureCache textureCache(textureCacheDir);
+    std::vector<AssetPackEntry> entries;
+    std::vector<AssetPackMip> mips;
+    std::vector<AssetPackMarker> markers;
+    std::unordered_map<std::string, uint32_t> assetByPath;
+    TimingStats parseTimes;
+
+    for (const AssetManifestEntry& item : manifest) {
+        auto it = assetByPath.find(item.objPath);
+        if (it == assetByPath.end()) {
+            ModelData data;
+            if (!parseObjModel(item.objPath, item.mtlBasePath, textureCache, data, true)) return 1;
+            parseTimes.add(data.parseMs);
+
+            AssetPackEntry entry{};
+            if (item.objFile.size() >= sizeof(entry.name)) {
+                std::cerr << "Error: Ruta demasiado larga para el paquete: " << item.objFile << std::endl;
+                return 1;
+            }
+            std::strncpy(entry.name, item.objFile.c_str(), sizeof(entry.name) - 1);
+            for (int c = 0; c < 3; ++c) {
+                entry.boundsMin[c] = data.boundsMin[c];
+                entry.boundsMax[c] = data.boundsMax[c];
+                entry.diffuseColor[c] = data.diffuseColor[c];
+            }
+
+            // Cada modelo empieza en su propia página: prefetch() y los fallos de página
+            // no arrastran datos de otros modelos.
+            entry.vertexCount = (uint32_t)(data.vertices.size() / 8);
+            entry.vertexBytes = data.vertices.size() * sizeof(float);
+            entry.vertexOffset = writer.align(AssetPack::pageAlignment);
+            writer.put(data.vertices.data(), entry.vertexBytes);
+            entry.checksum = AssetPack::checksum(data.vertices.data(), entry.vertexBytes);
+
+            entry.firstMip = (uint32_t)mips.size();
+            if (data.hasTexture && !data.texture.levels.empty()) {
+                entry.textureFormat = data.texture.format;
+                entry.mipLevels = (uint32_t)data.texture.levels.size();
+                for (const TextureCache::MipLevel& level : data.texture.levels) {
+                    AssetPackMip mip{};
+                    mip.width = (uint32_t)level.width;
+                    mip.height = (uint32_t)level.height;
+                    mip.bytes = level.data.size();
+                    mip.offset = writer.align(AssetPack::mipAlignment);
+                    writer.put(level.data.data(), level.data.size());
+                    entry.checksum = AssetPack::checksum(level.data.data(), level.data.size(), entry.checksum);
+                    mips.push_back(mip);
+                }
+            }
+
+            std::cout << "  " << entry.name << ": " << entry.vertexCount << " vértices, " << entry.mipLevels
+                      << " mips, " << (writer.tell() - entry.vertexOffset) / 1024 << " KB" << std::endl;
+            it = assetByPath.emplace(item.objPath, (uint32_t)entries.size()).first;
+            entries.push_back(entry);
+        }
+        markers.push_back({item.isDefault ? -1 : item.markerId, it->second});
+    }
+
+    header.assetCount = (uint32_t)entries.size();
+    header.mipCount = (uint32_t)mips.size();
+    header.markerCount = (uint32_t)markers.size();
+    header.indexOffset = writer.align(alignof(AssetPackEntry));
+
+    std::vector<uint8_t> index;
+    auto append = [&index](const void* data, size_t bytes) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        index.insert(index.end(), p, p + bytes);
+    };
+    append(entries.data(), entries.size() * sizeof(AssetPackEntry));
+    append(mips.data(), mips.size() * sizeof(AssetPackMip));
+    append(markers.data(), markers.size() * sizeof(AssetPackMarker));
+    writer.put(index.data(), index.size());
+    header.indexChecksum = AssetPack::checksum(index.data(), index.size());
+    header.fileSize = writer.tell();
+    if (!writer.rewriteHeader(header)) {
+        std::cerr << "Error: Falló la escritura de " << packPath << std::endl;
+        return 1;
+    }
+    std::cout << "Paquete " << packPath << ": " << entries.size() << " modelos, " << markers.size()
+              << " marcadores, " << header.fileSize / 1024 << " KB" << std::endl;
+
+    // Lo que hará la aplicación: abrir el índice y traer cada modelo con su suma.
+    const auto openStart = std::chrono::steady_clock::now();
+    AssetPack pack;
+    if (!pack.open(packPath)) return 1;
+    const double openMs = elapsedMs(openStart);
+    TimingStats loadTimes;
+    for (uint32_t i = 0; i < pack.assetCount(); ++i) {
+        const auto loadStart = std::chrono::steady_clock::now();
+        pack.prefetch(pack.entry(i));
+        if (!pack.verify(i)) {
+            std::cerr << "Error: Suma incorrecta al releer " << pack.entry(i).name << std::endl;
+            return 1;
+        }
+        loadTimes.add(elapsedMs(loadStart));
+    }
+    std::cout << "Apertura del paquete: " << openMs << " ms" << std::endl;
+    parseTimes.print("Parseo de OBJ + textura");
+    loadTimes.print("Carga desde el paquete (con suma)");
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Reproduce clips etiquetados a través de HandGestureDetector y reporta juntas
+// la precisión/exhaustividad y la distribución del coste por fotograma, de modo
+// que cada optimización del gesto se valide contra la misma verdad de referencia.
+//
+// Formato del manifiesto (una línea por clip, '#' para comentarios):
+//   fist   clips/puno_mesa_madera.mp4
+//   open   clips/mano_abierta_pared/*.png
+//   none   clips/fondo_beige.mp4
+// La ruta puede ser un video, un directorio de imágenes o un patrón con '*'.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <HandGestureDetector.h>
+#include <PerfStats.h>
+
+struct Clip {
+  std::string label; // fist, open o none
+  std::string path;
+};
+
+struct Counts {
+  long long truePositive = 0, falsePositive = 0, falseNegative = 0, trueNegative = 0;
+};
+
+static bool loadManifest(const std::string &path, std::vector<Clip> &clips) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Error: No se pudo abrir el manifiesto " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(file, line)) {
+    ++lineNumber;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream fields(line);
+    Clip clip;
+    if (!(fields >> clip.label >> clip.path)) continue;
+    if (clip.label != "fist" && clip.label != "open" && clip.label != "none") {
+      std::cerr << "Error: Etiqueta desconocida '" << clip.label << "' en la línea " << lineNumber << std::endl;
+      return false;
+    }
+    clips.push_back(clip);
+  }
+  return !clips.empty();
+}
+
+// Llama a onFrame por cada fotograma del clip; devuelve false si no se pudo abrir.
+template <typename Fn>
+static bool forEachFrame(const std::string &path, Fn onFrame) {
+  const bool isImageSet = path.find('*') != std::string::npos || path.back() == '/';
+  if (isImageSet) {
+    std::vector<std::string> files;
+    cv::glob(path.back() == '/' ? path + "*" : path, files);
+    for (const std::string &file : files) {
+      cv::Mat image = cv::imread(file, cv::IMREAD_COLOR);
+      if (!image.empty()) onFrame(image);
+    }
+    return !files.empty();
+  }
+
+  cv::VideoCapture video(path);
+  if (!video.isOpened()) return false;
+  cv::Mat frame;
+  while (video.read(frame)) onFrame(frame);
+  return true;
+}
+
+static void printUsage(const char *program) {
+  std::cout << "Uso: " << program << " <manifiesto> [--min-precision p] [--min-recall r]" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printUsage(argv[0]);
+    return -1;
+  }
+  double minPrecision = 0.0, minRecall = 0.0;
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg = argv[i];
+    try {
+      if (i + 1 < argc && arg == "--min-precision") {
+        minPrecision = std::stod(argv[++i]);
+      } else if (i + 1 < argc && arg == "--min-recall") {
+        minRecall = std::stod(argv[++i]);
+      } else {
+        printUsage(argv[0]);
+        return -1;
+      }
+    } catch (const std::exception &) {
+      std::cerr << "Error: Valor inválido para " << arg << std::endl;
+      return -1;
+    }
+  }
+
+  std::vector<Clip> clips;
+  if (!loadManifest(argv[1], clips)) return -1;
+
+  HandGestureDetector detector;
+  Counts total;
+  TimingStats frameCost;
+
+  for (const Clip &clip : clips) {
+    const bool positive = clip.label == "fist";
+    long long frames = 0, detections = 0;
+    TimingStats clipCost;
+
+    const bool opened = forEachFrame(clip.path, [&](const cv::Mat &frame) {
+      auto start = std::chrono::steady_clock::now();
+      const bool fist = detector.detect(frame);
+      const double ms = elapsedMs(start);
+      frameCost.add(ms);
+      clipCost.add(ms);
+
+      ++frames;
+      if (fist) ++detections;
+      if (positive && fist) ++total.truePositive;
+      if (positive && !fist) ++total.falseNegative;
+      if (!positive && fist) ++total.falsePositive;
+      if (!positive && !fist) ++total.trueNegative;
+    });
+    if (!opened) {
+      std::cerr << "Error: No se pudo abrir el clip " << clip.path << std::endl;
+      return -1;
+    }
+
+    std::cout << clip.label << "\t" << clip.path << ": " << frames << " fotogramas, puño en "
+              << (frames ? 100.0 * detections / frames : 0.0) << "%, media " << clipCost.mean() << " ms, p95 "
+              << clipCost.percentile(95) << " ms" << std::endl;
+  }
+
+  const long long predicted = total.truePositive + total.falsePositive;
+  const long long actual = total.truePositive + total.falseNegative;
+  const double precision = predicted ? (double)total.truePositive / predicted : 0.0;
+  const double recall = actual ? (double)total.truePositive / actual : 0.0;
+
+  std::cout << "\n--- RESULTADOS (positivo = puño) ---" << std::endl;
+  std::cout << "VP " << total.truePositive << ", FP " << total.falsePositive << ", FN " << total.falseNegative
+            << ", VN " << total.trueNegative << std::endl;
+  std::cout << "Precisión: " << precision << ", exhaustividad: " << recall << std::endl;
+  frameCost.print("Coste por fotograma");
+
+  if (precision < minPrecision || recall < minRecall) {
+    std::cerr << "FALLO: precisión/exhaustividad por debajo del mínimo (" << minPrecision << ", " << minRecall
+              << ")" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,189 @@
+// Colocación NUMA de varios pipelines de cámara (NumaPlacement.h). Cada pipeline es
+// un hilo con su pool de fotogramas y sus espacios de trabajo que repite, sobre
+// fotogramas de 1080p, lo que pesa en memoria por fotograma: copiar la captura al
+// pool, pasarla a grises y reducirla para la visión.
+//
+//   numa_bench [--pipelines n] [--frames n] [--pool n] [--width w] [--height h]
+//
+// Se mide dos veces:
+//   - oblivious: el hilo principal reserva todos los pools (como un asignador
+//     central) y los hilos quedan donde los ponga el planificador;
+//   - local: el pipeline i se ata al nodo i % nodos y reserva y toca su propia
+//     memoria, que queda en ese nodo.
+// La reserva queda fuera de la medida en las dos pasadas: los hilos esperan en una
+// barrera a que todos tengan su memoria y solo entonces empieza el reloj.
+// Para cada pasada se informa el rendimiento y la fracción de páginas de cada pool
+// que está en el nodo donde corrió su hilo. Con un solo nodo ambas deben coincidir.
+
+#include <sched.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <NumaPlacement.h>
+#include <PerfStats.h>
+
+struct CameraPipeline {
+    std::unique_ptr<NumaPlacement> placement;
+    cv::Mat capture;            // lo que entregaría el driver de la cámara
+    std::vector<cv::Mat> pool;  // fotogramas reciclados
+    cv::Mat gray, vision;       // espacios de trabajo
+    double seconds = 0.0;
+    double checksum = 0.0;
+    int cpu = -1;               // donde terminó el hilo
+};
+
+static void allocate(CameraPipeline& pipeline, cv::Size size, int poolSize) {
+    // setTo() toca cada página: la primera escritura decide el nodo.
+    pipeline.capture.create(size, CV_8UC3);
+    cv::randu(pipeline.capture, 0, 255);
+    pipeline.pool.assign(poolSize, cv::Mat());
+    for (cv::Mat& frame : pipeline.pool) {
+        frame.create(size, CV_8UC3);
+        frame.setTo(cv::Scalar::all(0));
+    }
+    pipeline.gray.create(size, CV_8UC1);
+    pipeline.gray.setTo(0);
+    pipeline.vision.create(size / 2, CV_8UC1);
+    pipeline.vision.setTo(0);
+}
+
+static void runFrames(CameraPipeline& pipeline, int frames) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        cv::Mat& frame = pipeline.pool[(size_t)i % pipeline.pool.size()];
+        pipeline.capture.copyTo(frame);
+        cv::cvtColor(frame, pipeline.gray, cv::COLOR_BGR2GRAY);
+        cv::resize(pipeline.gray, pipeline.vision, pipeline.vision.size(), 0, 0, cv::INTER_AREA);
+        pipeline.checksum += pipeline.vision.at<uchar>(i % pipeline.vision.rows, 0);
+    }
+    pipeline.seconds = elapsedMs(start) / 1000.0;
+    pipeline.cpu = sched_getcpu();
+}
+
+// Fracción de las páginas muestreadas del pool que están en el nodo del hilo.
+static double localFraction(const CameraPipeline& pipeline, const NumaTopology& topology) {
+    const int node = topology.nodeOfCpu(pipeline.cpu);
+    long long total = 0, local = 0;
+    for (const cv::Mat& frame : pipeline.pool) {
+        for (int pageNode : NumaPlacement::pageNodes(frame.data, frame.total() * frame.elemSize(), 32)) {
+            total++;
+            if (pageNode == node) local++;
+        }
+    }
+    return total ? (double)local / total : 0.0;
+}
+
+// Los hilos avisan cuando su memoria está lista y esperan la salida común.
+class StartGate {
+public:
+    explicit StartGate(int threads) : pending(threads) {}
+
+    void arriveAndWait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (--pending == 0) allReady.notify_all();
+        released.wait(lock, [&] { return open; });
+    }
+
+    // Espera a que lleguen todos y los suelta; devuelve el instante de salida.
+    std::chrono::steady_clock::time_point openWhenReady() {
+        std::unique_lock<std::mutex> lock(mutex);
+        allReady.wait(lock, [&] { return pending == 0; });
+        open = true;
+        released.notify_all();
+        return std::chrono::steady_clock::now();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable allReady, released;
+    int pending;
+    bool open = false;
+};
+
+static void runPass(const std::string& name, bool local, const NumaTopology& topology, int pipelineCount,
+                    int frames, int poolSize, cv::Size size) {
+    std::vector<CameraPipeline> pipelines(pipelineCount);
+    const std::vector<NumaTopology::Node>& nodes = topology.nodes();
+    if (!local) {
+        for (CameraPipeline& pipeline : pipelines) allocate(pipeline, size, poolSize);
+    }
+
+    std::vector<std::thread> threads;
+    StartGate gate(pipelineCount);
+    for (int i = 0; i < pipelineCount; ++i) {
+        threads.emplace_back([&, i] {
+            CameraPipeline& pipeline = pipelines[i];
+            if (local) {
+                pipeline.placement = std::make_unique<NumaPlacement>(nodes[(size_t)i % nodes.size()].id);
+                pipeline.placement->bindCurrentThread("cámara " + std::to_string(i));
+                allocate(pipeline, size, poolSize);
+            }
+            gate.arriveAndWait();
+            runFrames(pipeline, frames);
+        });
+    }
+    const auto start = gate.openWhenReady();
+    for (std::thread& thread : threads) thread.join();
+    const double seconds = elapsedMs(start) / 1000.0;
+
+    TimingStats fps;
+    double localSum = 0.0;
+    for (const CameraPipeline& pipeline : pipelines) {
+        fps.add(frames / std::max(1e-9, pipeline.seconds));
+        localSum += localFraction(pipeline, topology);
+    }
+    const double frameBytes = (double)size.area() * (3 + 3 + 1 + 1 + 0.25); // copia, grises y reducción
+    const double totalFrames = (double)frames * pipelineCount;
+    std::cout << name << ": " << totalFrames / seconds << " fps en total, por pipeline media " << fps.mean()
+              << " (mín " << fps.percentile(0) << ", máx " << fps.percentile(100) << "), "
+              << totalFrames * frameBytes / seconds / 1e9 << " GB/s; " << 100.0 * localSum / pipelineCount
+              << "% de páginas del pool en el nodo del hilo" << std::endl;
+    if (local) pipelines[0].placement->printReport();
+}
+
+int main(int argc, char** argv) {
+    int pipelineCount = 8, frames = 300, poolSize = 4;
+    cv::Size size(1920, 1080);
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--pipelines") {
+            pipelineCount = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--frames") {
+            frames = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--pool") {
+            poolSize = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--width") {
+            size.width = std::max(16, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--height") {
+            size.height = std::max(16, std::stoi(argv[++i]));
+        } else {
+            std::cerr << "Uso: " << argv[0]
+                      << " [--pipelines n] [--frames n] [--pool n] [--width w] [--height h]" << std::endl;
+            return -1;
+        }
+    }
+
+    // Cada pipeline en un solo hilo: el pool de hilos de OpenCV cruzaría nodos.
+    cv::setNumThreads(1);
+    const NumaTopology topology = NumaTopology::detect();
+    std::cout << "Topología:";
+    for (const NumaTopology::Node& node : topology.nodes())
+        std::cout << " nodo " << node.id << " (CPUs " << NumaTopology::formatCpuList(node.cpus) << ")";
+    std::cout << "; " << pipelineCount << " pipelines de " << size.width << "x" << size.height << ", pool de "
+              << poolSize << ", " << frames << " fotogramas" << std::endl;
+    if (topology.nodes().size() < 2)
+        std::cout << "Un solo nodo: las dos pasadas deberían rendir lo mismo." << std::endl;
+
+    runPass("oblivious", false, topology, pipelineCount, frames, poolSize, size);
+    runPass("local    ", true, topology, pipelineCount, frames, poolSize, size);
+    return 0;
+}
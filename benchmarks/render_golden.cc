@@ -0,0 +1,200 @@
+// Regresión de imagen y rendimiento de ARObjectRenderer. Renderiza poses, fondos
+// y modos de composición fijos en un contexto oculto (FBO), compara cada imagen con
+// su imagen dorada usando una tolerancia perceptual (ΔE en CIELAB) y registra el
+// tiempo de render de cada caso, de modo que la misma batería vigila corrección y
+// rendimiento (por ejemplo bajo llvmpipe).
+//
+//   render_golden [--golden-dir dir] [--model obj] [--mtl-dir dir] [--update] [--runs n]
+//
+// Con --update se regeneran las imágenes doradas en lugar de comparar. Las imágenes
+// no vienen con el repositorio (dependen del modelo, que tampoco): hay que generarlas
+// una vez con --update sobre un render de referencia y conservar el directorio. Sin
+// ellas la comparación falla de entrada (código 2) en lugar de aprobar o regenerarlas.
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include <ARRenderer.h>
+#include <PerfStats.h>
+
+struct GoldenCase {
+  std::string name;
+  std::string background; // gradient, checker o solid
+  cv::Vec3d rvec, tvec;
+  CompositeMode mode;
+  float modelScale;
+};
+
+static const cv::Size frameSize(640, 480);
+
+static cv::Mat makeBackground(const std::string &kind) {
+  cv::Mat image(frameSize, CV_8UC3);
+  for (int y = 0; y < image.rows; ++y) {
+    for (int x = 0; x < image.cols; ++x) {
+      cv::Vec3b &px = image.at<cv::Vec3b>(y, x);
+      if (kind == "checker") {
+        const bool light = ((x / 40) + (y / 40)) % 2 == 0;
+        px = light ? cv::Vec3b(200, 200, 200) : cv::Vec3b(60, 60, 60);
+      } else if (kind == "gradient") {
+        px = cv::Vec3b((uchar)(255 * x / image.cols), (uchar)(255 * y / image.rows), 128);
+      } else {
+        px = cv::Vec3b(90, 140, 170);
+      }
+    }
+  }
+  return image;
+}
+
+static std::vector<GoldenCase> buildCases() {
+  const cv::Vec3d frontal(CV_PI, 0, 0), tilted(2.6, 0.3, 0.2), turned(2.9, -0.4, 1.2);
+  const cv::Vec3d near(0, 0, 0.25), far(0.02, -0.01, 0.6), offset(-0.05, 0.03, 0.35);
+  std::vector<GoldenCase> cases;
+  for (CompositeMode mode : {CompositeMode::Legacy, CompositeMode::FillRate}) {
+    const std::string prefix = mode == CompositeMode::Legacy ? "legacy_" : "fillrate_";
+    cases.push_back({prefix + "frontal_checker", "checker", frontal, near, mode, 1.0f});
+    cases.push_back({prefix + "tilted_gradient", "gradient", tilted, far, mode, 1.0f});
+    cases.push_back({prefix + "turned_solid", "solid", turned, offset, mode, 1.0f});
+    cases.push_back({prefix + "behind_camera", "gradient", frontal, cv::Vec3d(0, 0, -0.3), mode, 1.0f});
+  }
+  cases.push_back({"half_scale_frontal", "checker", frontal, near, CompositeMode::Legacy, 0.5f});
+  cases.push_back({"half_scale_tilted", "gradient", tilted, far, CompositeMode::Legacy, 0.5f});
+  return cases;
+}
+
+// Diferencia perceptual: ΔE por píxel en CIELAB tras un leve desenfoque que
+// absorbe diferencias de rasterizado de subpíxel entre drivers.
+static void perceptualDiff(const cv::Mat &a, const cv::Mat &b, double &meanDeltaE, double &badFraction,
+                           double badThreshold) {
+  cv::Mat blurA, blurB, labA, labB;
+  cv::GaussianBlur(a, blurA, cv::Size(3, 3), 0);
+  cv::GaussianBlur(b, blurB, cv::Size(3, 3), 0);
+  blurA.convertTo(blurA, CV_32F, 1.0 / 255.0);
+  blurB.convertTo(blurB, CV_32F, 1.0 / 255.0);
+  cv::cvtColor(blurA, labA, cv::COLOR_BGR2Lab);
+  cv::cvtColor(blurB, labB, cv::COLOR_BGR2Lab);
+
+  double sum = 0.0;
+  long long bad = 0;
+  for (int y = 0; y < labA.rows; ++y) {
+    const cv::Vec3f *pa = labA.ptr<cv::Vec3f>(y);
+    const cv::Vec3f *pb = labB.ptr<cv::Vec3f>(y);
+    for (int x = 0; x < labA.cols; ++x) {
+      const float dl = pa[x][0] - pb[x][0], da = pa[x][1] - pb[x][1], db = pa[x][2] - pb[x][2];
+      const double deltaE = std::sqrt(dl * dl + da * da + db * db);
+      sum += deltaE;
+      if (deltaE > badThreshold) ++bad;
+    }
+  }
+  const double pixels = (double)labA.rows * labA.cols;
+  meanDeltaE = sum / pixels;
+  badFraction = bad / pixels;
+}
+
+int main(int argc, char **argv) {
+  std::string goldenDir = "golden";
+  std::string objPath = "../../rata-centrada.obj";
+  std::string mtlBasePath = "../../";
+  bool update = false;
+  int runs = 20;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--update") {
+      update = true;
+    } else if (i + 1 < argc && arg == "--golden-dir") {
+      goldenDir = argv[++i];
+    } else if (i + 1 < argc && arg == "--model") {
+      objPath = argv[++i];
+    } else if (i + 1 < argc && arg == "--mtl-dir") {
+      mtlBasePath = argv[++i];
+    } else if (i + 1 < argc && arg == "--runs") {
+      runs = std::max(1, std::stoi(argv[++i]));
+    } else {
+      std::cerr << "Uso: " << argv[0] << " [--golden-dir dir] [--model obj] [--mtl-dir dir] [--update] [--runs n]"
+                << std::endl;
+      return -1;
+    }
+  }
+
+  // Tolerancias: ΔE medio y fracción de píxeles con ΔE > 10 (diferencia visible).
+  const double maxMeanDeltaE = 1.0, badDeltaE = 10.0, maxBadFraction = 0.002;
+
+  const std::vector<GoldenCase> cases = buildCases();
+  if (!update) {
+    int missing = 0;
+    for (const GoldenCase &c : cases) {
+      const std::string goldenPath = goldenDir + "/" + c.name + ".png";
+      if (!std::filesystem::exists(goldenPath)) {
+        std::cerr << "Falta la imagen dorada " << goldenPath << std::endl;
+        ++missing;
+      }
+    }
+    if (missing) {
+      std::cerr << "Error: Faltan " << missing << " de " << cases.size() << " imágenes doradas en " << goldenDir
+                << "; genérelas con --update desde un render de referencia antes de comparar." << std::endl;
+      return 2;
+    }
+  }
+
+  ARObjectRenderer renderer;
+  if (!renderer.init(frameSize.width, frameSize.height, "render_golden", false) ||
+      !renderer.setOffscreenOutput(true) || !renderer.loadModel(objPath, mtlBasePath)) {
+    std::cerr << "Error: No se pudo preparar el renderizador fuera de pantalla." << std::endl;
+    return -1;
+  }
+  if (update)
+    std::filesystem::create_directories(goldenDir);
+
+  const cv::Mat cameraMatrix = (cv::Mat_<double>(3, 3) << 600, 0, 320, 0, 600, 240, 0, 0, 1);
+  int failures = 0;
+  for (const GoldenCase &c : cases) {
+    const cv::Mat background = makeBackground(c.background);
+    renderer.setCompositeMode(c.mode);
+    renderer.setModelRenderScale(c.modelScale);
+
+    // Primer render para calentar; después se promedian 'runs' renders con glFinish.
+    renderer.render(background, c.rvec, c.tvec, cameraMatrix);
+    TimingStats times;
+    for (int r = 0; r < runs; ++r) {
+      auto start = std::chrono::steady_clock::now();
+      renderer.render(background, c.rvec, c.tvec, cameraMatrix);
+      glFinish();
+      times.add(elapsedMs(start));
+    }
+    const cv::Mat image = renderer.readOutput();
+    const std::string goldenPath = goldenDir + "/" + c.name + ".png";
+
+    if (update) {
+      cv::imwrite(goldenPath, image);
+      std::cout << "ACTUALIZADO " << c.name << " (" << times.mean() << " ms)" << std::endl;
+      continue;
+    }
+
+    const cv::Mat golden = cv::imread(goldenPath, cv::IMREAD_COLOR);
+    if (golden.empty() || golden.size() != image.size()) {
+      std::cout << "FALLO " << c.name << ": imagen dorada ilegible o de otro tamaño " << goldenPath << std::endl;
+      ++failures;
+      continue;
+    }
+    double meanDeltaE = 0.0, badFraction = 0.0;
+    perceptualDiff(image, golden, meanDeltaE, badFraction, badDeltaE);
+    const bool ok = meanDeltaE <= maxMeanDeltaE && badFraction <= maxBadFraction;
+    if (!ok) {
+      ++failures;
+      cv::imwrite(goldenDir + "/" + c.name + ".actual.png", image);
+    }
+    std::cout << (ok ? "OK    " : "FALLO ") << c.name << ": ΔE medio " << meanDeltaE << ", píxeles distintos "
+              << badFraction * 100.0 << "%, render media " << times.mean() << " ms, p95 " << times.percentile(95)
+              << " ms" << std::endl;
+  }
+
+  if (failures) {
+    std::cerr << failures << " caso(s) difieren de las imágenes doradas." << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,184 @@
+// Compara el pipeline de visión instanciado en compilación (VisionPipeline con
+// etapas concretas) con el respaldo de std::function (DynamicVisionPipeline) sobre
+// los mismos fotogramas sintéticos en memoria, sin E/S de por medio.
+//
+//   vision_pipeline_bench [--frames n] [--passes p]
+//
+// Se mide dos veces: con detección y pose reales (coste total por fotograma) y
+// con etapas triviales, que aíslan el coste de las fronteras entre etapas. Las
+// poses de ambos pipelines deben coincidir.
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include <PerfStats.h>
+#include <VisionPipeline.h>
+
+// Fuente en memoria que recorre los fotogramas en bucle; final para que
+// FrameSourceStage<MemoryFrameSource> se desvirtualice.
+class MemoryFrameSource final : public FrameSource {
+public:
+    explicit MemoryFrameSource(const std::vector<cv::Mat>& frames) : frames(frames) {}
+
+    bool isOpened() const override { return !frames.empty(); }
+
+    bool read(cv::Mat& frame) override {
+        if (next >= frames.size()) return false;
+        frame = frames[next++]; // sin copia: comparte los datos
+        return true;
+    }
+
+    void rewind() { next = 0; }
+
+private:
+    const std::vector<cv::Mat>& frames;
+    size_t next = 0;
+};
+
+// Marcador de 120 px que recorre un fondo gris con algo de ruido.
+static std::vector<cv::Mat> makeFrames(const cv::aruco::Dictionary& dictionary, int count) {
+    cv::Mat marker;
+    cv::aruco::generateImageMarker(dictionary, 23, 120, marker, 1);
+    cv::cvtColor(marker, marker, cv::COLOR_GRAY2BGR);
+    cv::Mat border(marker.rows + 40, marker.cols + 40, CV_8UC3, cv::Scalar(255, 255, 255));
+    marker.copyTo(border(cv::Rect(20, 20, marker.cols, marker.rows)));
+
+    std::vector<cv::Mat> frames;
+    cv::RNG rng(7);
+    for (int i = 0; i < count; ++i) {
+        cv::Mat frame(480, 640, CV_8UC3, cv::Scalar(110, 110, 110));
+        cv::Mat noise(frame.size(), CV_8UC3);
+        rng.fill(noise, cv::RNG::UNIFORM, 0, 20);
+        frame += noise;
+        const double t = (double)i / count * 2.0 * CV_PI;
+        const int x = (int)((frame.cols - border.cols) * (0.5 + 0.4 * std::cos(t)));
+        const int y = (int)((frame.rows - border.rows) * (0.5 + 0.4 * std::sin(2.0 * t)));
+        border.copyTo(frame(cv::Rect(x, y, border.cols, border.rows)));
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+struct PoseRecord {
+    bool found;
+    cv::Vec3d tvec;
+};
+
+// Sin frameTimes no se toma la hora por fotograma, que dominaría en las etapas triviales.
+template <typename Pipeline>
+static double runPasses(Pipeline& pipeline, MemoryFrameSource& source, int passes, TimingStats* frameTimes) {
+    VisionFrame frame;
+    const auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p) {
+        source.rewind();
+        if (!frameTimes) {
+            while (pipeline.step(frame)) {
+            }
+            continue;
+        }
+        while (true) {
+            const auto frameStart = std::chrono::steady_clock::now();
+            if (!pipeline.step(frame)) break;
+            frameTimes->add(elapsedMs(frameStart));
+        }
+    }
+    return elapsedMs(start);
+}
+
+int main(int argc, char** argv) {
+    int frameCount = 240;
+    int passes = 5;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--frames") {
+            frameCount = std::max(1, std::stoi(argv[++i]));
+        } else if (i + 1 < argc && arg == "--passes") {
+            passes = std::max(1, std::stoi(argv[++i]));
+        } else {
+            std::cerr << "Uso: " << argv[0] << " [--frames n] [--passes p]" << std::endl;
+            return -1;
+        }
+    }
+
+    const cv::aruco::Dictionary dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_6X6_250);
+    const cv::aruco::ArucoDetector detector(dictionary);
+    const std::vector<cv::Mat> frames = makeFrames(dictionary, frameCount);
+    MemoryFrameSource source(frames);
+    const float markerLength = 0.05f;
+
+    // --- Detección y pose reales ---
+    std::vector<PoseRecord> staticPoses, dynamicPoses;
+    auto recordInto = [](std::vector<PoseRecord>& poses) {
+        return [&poses](VisionFrame& frame) { poses.push_back({frame.markerFound, frame.tvec}); };
+    };
+
+    cv::Mat staticCamera, staticDist;
+    auto staticPipeline = makeVisionPipeline(FrameSourceStage<MemoryFrameSource>{&source}, ArucoDetectorStage{&detector},
+                                             PnPPoseStage(&staticCamera, &staticDist, markerLength), NoGesture{},
+                                             makeCallbackSink(recordInto(staticPoses)));
+    TimingStats staticTimes;
+    const double staticMs = runPasses(staticPipeline, source, passes, &staticTimes);
+
+    cv::Mat dynamicCamera, dynamicDist;
+    DynamicVisionPipeline dynamicPipeline(
+        DynamicSource{[&source](VisionFrame& frame) { return source.readForVision(frame.image, frame.scale); }},
+        DynamicStage{[stage = ArucoDetectorStage{&detector}](VisionFrame& frame) mutable { stage.detect(frame); }},
+        DynamicStage{[stage = PnPPoseStage(&dynamicCamera, &dynamicDist, markerLength)](VisionFrame& frame) mutable {
+            stage.solve(frame);
+        }},
+        DynamicStage{}, DynamicStage{recordInto(dynamicPoses)});
+    TimingStats dynamicTimes;
+    const double dynamicMs = runPasses(dynamicPipeline, source, passes, &dynamicTimes);
+
+    long long found = 0, mismatches = 0;
+    for (size_t i = 0; i < staticPoses.size() && i < dynamicPoses.size(); ++i) {
+        if (staticPoses[i].found) found++;
+        if (staticPoses[i].found != dynamicPoses[i].found ||
+            cv::norm(staticPoses[i].tvec - dynamicPoses[i].tvec) > 1e-9)
+            mismatches++;
+    }
+    if (staticPoses.size() != dynamicPoses.size()) mismatches++;
+
+    const long long total = (long long)frameCount * passes;
+    std::cout << total << " fotogramas de " << frames[0].cols << "x" << frames[0].rows << ", pose en " << found
+              << ", diferencias entre pipelines: " << mismatches << std::endl;
+    std::cout << "Estático: " << total / (staticMs / 1000.0) << " fps, dinámico: " << total / (dynamicMs / 1000.0)
+              << " fps" << std::endl;
+    staticTimes.print("Pipeline estático (detección + pose)");
+    dynamicTimes.print("Pipeline dinámico (detección + pose)");
+
+    // --- Solo fronteras entre etapas: etapas que apenas tocan el fotograma ---
+    long long staticChecksum = 0, dynamicChecksum = 0;
+    struct MarkAll {
+        void detect(VisionFrame& frame) { frame.markerFound = frame.image.data != nullptr; }
+    };
+    struct TouchPose {
+        void solve(VisionFrame& frame) { frame.tvec[2] = (double)frame.index; }
+    };
+    auto staticDispatch = makeVisionPipeline(
+        FrameSourceStage<MemoryFrameSource>{&source}, MarkAll{}, TouchPose{}, NoGesture{},
+        makeCallbackSink([&staticChecksum](VisionFrame& frame) { staticChecksum += (long long)frame.tvec[2]; }));
+    DynamicVisionPipeline dynamicDispatch(
+        DynamicSource{[&source](VisionFrame& frame) { return source.readForVision(frame.image, frame.scale); }},
+        DynamicStage{[](VisionFrame& frame) { MarkAll{}.detect(frame); }},
+        DynamicStage{[](VisionFrame& frame) { TouchPose{}.solve(frame); }},
+        DynamicStage{[](VisionFrame&) {}},
+        DynamicStage{[&dynamicChecksum](VisionFrame& frame) { dynamicChecksum += (long long)frame.tvec[2]; }});
+
+    const int dispatchPasses = passes * 200;
+    const double staticDispatchMs = runPasses(staticDispatch, source, dispatchPasses, nullptr);
+    const double dynamicDispatchMs = runPasses(dynamicDispatch, source, dispatchPasses, nullptr);
+    const double dispatchFrames = (double)frameCount * dispatchPasses;
+    std::cout << "Coste por fotograma sin trabajo: estático " << staticDispatchMs * 1e6 / dispatchFrames
+              << " ns, dinámico " << dynamicDispatchMs * 1e6 / dispatchFrames << " ns" << std::endl;
+    if (staticChecksum != dynamicChecksum) {
+        std::cerr << "Error: los pipelines de despacho no coinciden" << std::endl;
+        return 1;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
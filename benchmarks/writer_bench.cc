@@ -0,0 +1,114 @@
+// Rendimiento sostenido de AsyncFileWriter con varios flujos a la vez. Cada flujo
+// tiene su propio hilo productor que escribe bloques del tamaño de un fotograma
+// MJPEG; se mide el caudal total, la latencia de cada write() (lo que vería el hilo
+// de captura) y la memoria de búferes, que no depende del volumen escrito.
+//
+//   writer_bench [--dir d] [--streams n] [--idle-streams n] [--mb m] [--chunk-kb k]
+//                [--buffer-kb b] [--buffers n] [--direct] [--threads]
+//
+// --threads fuerza el respaldo con pwrite para compararlo con io_uring.
+// --idle-streams abre flujos que escriben una cabecera y quedan ociosos hasta el
+// final, como un registro de poses sin detecciones: cada uno retiene un búfer a medio
+// llenar y los activos tienen que arreglarse con el resto. Con tantos flujos como
+// búferes, open() rechaza el último en lugar de dejar que write() se bloquee.
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <AsyncFileWriter.h>
+#include <PerfStats.h>
+#include <ResourceTracker.h>
+
+int main(int argc, char **argv) {
+  std::string dir = "writer_bench_out";
+  int streams = 4;
+  int idleStreams = 1;
+  long long megabytesPerStream = 256;
+  size_t chunkBytes = 60 * 1024; // ~ un JPEG de 640x480
+  bool direct = false;
+  AsyncFileWriter::Options options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--direct") {
+      direct = true;
+    } else if (arg == "--threads") {
+      options.useIoUring = false;
+    } else if (i + 1 < argc && arg == "--dir") {
+      dir = argv[++i];
+    } else if (i + 1 < argc && arg == "--streams") {
+      streams = std::max(1, std::stoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "--idle-streams") {
+      idleStreams = std::max(0, std::stoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "--mb") {
+      megabytesPerStream = std::max(1LL, std::stoll(argv[++i]));
+    } else if (i + 1 < argc && arg == "--chunk-kb") {
+      chunkBytes = (size_t)std::max(1, std::stoi(argv[++i])) * 1024;
+    } else if (i + 1 < argc && arg == "--buffer-kb") {
+      options.bufferSize = (size_t)std::max(4, std::stoi(argv[++i])) * 1024;
+    } else if (i + 1 < argc && arg == "--buffers") {
+      options.bufferCount = std::max(1, std::stoi(argv[++i]));
+    } else {
+      std::cerr << "Uso: " << argv[0]
+                << " [--dir d] [--streams n] [--idle-streams n] [--mb m] [--chunk-kb k] [--buffer-kb b] [--buffers n]"
+                   " [--direct] [--threads]"
+                << std::endl;
+      return -1;
+    }
+  }
+  std::filesystem::create_directories(dir);
+
+  AsyncFileWriter writer(options);
+  std::cout << "Backend: " << writer.backendName() << ", " << streams << " flujos (+" << idleStreams
+            << " ociosos), "
+            << writer.bufferBytes() / 1024 << " KB de búferes" << (direct ? ", O_DIRECT" : "") << std::endl;
+
+  std::vector<int> idleIds;
+  for (int s = 0; s < idleStreams; ++s) {
+    const int id = writer.open(dir + "/idle" + std::to_string(s) + ".bin", direct);
+    if (id < 0) return -1;
+    writer.write(id, "frame,timestamp_us,found\n");
+    idleIds.push_back(id);
+  }
+
+  std::vector<int> ids;
+  for (int s = 0; s < streams; ++s) {
+    const int id = writer.open(dir + "/stream" + std::to_string(s) + ".bin", direct);
+    if (id < 0) return -1;
+    ids.push_back(id);
+  }
+
+  const long long bytesPerStream = megabytesPerStream * 1024 * 1024;
+  std::vector<TimingStats> writeTimes(streams);
+  std::vector<std::thread> producers;
+  const auto start = std::chrono::steady_clock::now();
+  for (int s = 0; s < streams; ++s) {
+    producers.emplace_back([&, s] {
+      std::vector<uint8_t> chunk(chunkBytes, (uint8_t)('a' + s));
+      for (long long written = 0; written < bytesPerStream; written += (long long)chunk.size()) {
+        const auto writeStart = std::chrono::steady_clock::now();
+        writer.write(ids[s], chunk.data(), chunk.size());
+        writeTimes[s].add(elapsedMs(writeStart));
+      }
+    });
+  }
+  for (std::thread &producer : producers) producer.join();
+  for (int id : ids) writer.close(id);
+  for (int id : idleIds) writer.close(id);
+  const double seconds = elapsedMs(start) / 1000.0;
+
+  const AsyncFileWriter::Stats stats = writer.stats();
+  const double megabytes = stats.bytesWritten / (1024.0 * 1024.0);
+  std::cout << "Escritos " << megabytes << " MB en " << seconds << " s: " << megabytes / seconds << " MB/s ("
+            << stats.writes << " escrituras en " << stats.batches << " lotes, " << stats.bufferWaits
+            << " esperas de búfer, " << stats.errors << " errores)" << std::endl;
+  for (int s = 0; s < streams; ++s)
+    writeTimes[s].print("write() flujo " + std::to_string(s));
+
+  const ResourceTracker::CategoryStats memory = ResourceTracker::instance().stats(ResourceCategory::IoBuffers);
+  std::cout << "Memoria de búferes: pico " << memory.peakBytes / 1024 << " KB" << std::endl;
+  return stats.errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <FramePacer.h>
+#include <GpuUploader.h>
+#include <OffscreenFramebuffer.h>
+#include <PerfStats.h>
+#include <RenderCommandList.h>
+#include <ResourceTracker.h>
+#include <SceneGraph.h>
+#include <ShaderPermutations.h>
+#include <TextureCache.h>
+
+struct GLFWwindow;
+class AssetManager;
+
+// Pose de un marcador detectado, para dibujar el modelo que le asigna el AssetManager.
+struct MarkerPose {
+    int id = 0;
+    cv::Vec3d rvec, tvec;
+};
+
+struct Model {
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    int vertexCount = 0;
+    glm::vec3 diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+    GLuint diffuseTexture = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    uint32_t generation = 0; // aumenta con cada cambio en caliente
+};
+
+// Modelo leído y preparado en CPU, pendiente de subir a la GPU (ver parseModel).
+struct ModelData {
+    std::string objPath;
+    std::vector<float> vertices; // posición, normal y UV intercalados (8 floats)
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    glm::vec3 diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+    bool hasTexture = false;
+    TextureCache::PreparedTexture texture;
+    double parseMs = 0.0;
+    TrackedAllocation staging{ResourceCategory::ModelStaging};
+};
+
+// Lee un OBJ y arma los vértices intercalados y la textura preparada. No toca GL.
+bool parseObjModel(const std::string& objPath, const std::string& mtlBasePath, const TextureCache& textureCache,
+                   ModelData& data, bool compressTextures);
+// Crea el VAO/VBO de un modelo; vertices == nullptr solo reserva el buffer.
+void createModelBuffers(Model& model, size_t bytes, const float* vertices);
+// Las dos mitades de createModelBuffers. El VBO se puede crear en el contexto de
+// subidas (GpuUploader); el VAO no se comparte y se arma en el de render.
+void createVertexBuffer(Model& model, size_t bytes, const float* vertices);
+void attachVertexArray(Model& model);
+// VBO y textura de un modelo parseado, sin VAO. Devuelve los bytes que ocupan en la GPU.
+size_t uploadModelResources(ModelData& data, TextureCache& textureCache, Model& model);
+// Borra los objetos GL del modelo y lo deja vacío.
+void releaseModelBuffers(Model& model);
+
+// Orden de composición del fondo y el modelo.
+enum class CompositeMode {
+    Legacy,   // limpiar todo, fondo, limpiar profundidad, modelo
+    FillRate  // modelo primero, fondo en el plano lejano con test de profundidad
+};
+
+// --- Coste de relleno medido por modo de composición ---
+struct CompositeStats {
+    long long frames = 0;
+    long long timedFrames = 0;
+    double gpuMs = 0.0;          // tiempo de GPU (GL_TIME_ELAPSED)
+    double samplesPassed = 0.0;  // fragmentos que pasan el test de profundidad
+    double clearedPixels = 0.0;  // píxeles de color + profundidad limpiados
+};
+
+// --- Redibujos evitados por seguimiento de daño (ver setDamageTracking) ---
+// Un fotograma dibujado cuenta en cada motivo que lo provocó.
+struct DamageStats {
+    long long drawn = 0;
+    long long skipped = 0;    // sin cambios: ni dibujo ni intercambio de buffers
+    long long background = 0; // la imagen de cámara cambió
+    long long commands = 0;   // pose, modelo u overlay distintos
+    long long animation = 0;  // animación en curso
+    long long window = 0;     // redimensionado o exposición de la ventana
+};
+
+// --- Estadísticas de recursos del renderizador ---
+struct RendererStats {
+    size_t vertexBytes = 0;
+    size_t textureGpuBytes = 0;
+    size_t textureRawBytes = 0;
+    double modelLoadMs = 0.0;
+    double textureLoadMs = 0.0;
+    bool texturesFromCache = false;
+    int modelSwaps = 0;
+    double lastSwapMs = 0.0;       // desde la petición hasta que el modelo nuevo se dibuja
+    int lastSwapUploadFrames = 0;  // fotogramas que tomó la subida por partes
+    long long backgroundUploads = 0;
+    double backgroundUploadBytes = 0.0; // bytes del fondo subidos, ya ajustado a la ventana
+    double backgroundFrameBytes = 0.0;  // bytes que habría costado subirlo a resolución de cámara
+    CompositeStats composite[2]; // indexado por CompositeMode
+    DamageStats damage;
+    ResourceTracker::CategoryStats memory[(int)ResourceCategory::Count]; // instantánea tomada en getStats()
+};
+
+// --- Comportamiento por objeto del renderizador (políticas de compilación) ---
+// Cada política define:
+//   static bool visible(const cv::Vec3d& tvec)      si se dibuja con esta pose
+//   static glm::mat4 baseTransform()                orientación y escala del OBJ
+//   static constexpr bool animated                  si triggerAnimation() hace algo
+//   static bool animate(float elapsed, glm::mat4&)  local del objeto; false al terminar
+
+// Modelo de la rata: solo frente a la cámara, OBJ en milímetros y un salto al
+// detectar el gesto.
+struct AnimatedModelPolicy {
+    static bool visible(const cv::Vec3d& tvec) { return tvec[2] > 0; }
+
+    static glm::mat4 baseTransform() {
+        const glm::mat4 base = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        return glm::scale(base, glm::vec3(0.001f));
+    }
+
+    static constexpr bool animated = true;
+    static constexpr float animationDuration = 1.0f;
+    static constexpr float animationHeight = 0.05f;
+    static bool animate(float elapsed, glm::mat4& local) {
+        if (elapsed >= animationDuration) return false;
+        local = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, animationHeight * (elapsed / animationDuration), 0.0f));
+        return true;
+    }
+};
+
+// Objeto fijo sobre el marcador (el antiguo ARCubeRenderer): siempre visible,
+// OBJ en centímetros y sin animación.
+struct StaticModelPolicy {
+    static bool visible(const cv::Vec3d&) { return true; }
+
+    static glm::mat4 baseTransform() {
+        const glm::mat4 base = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+        return glm::scale(base, glm::vec3(0.01f));
+    }
+
+    static constexpr bool animated = false;
+    static bool animate(float, glm::mat4&) { return false; }
+};
+
+// --- Renderizador AR: fondo de cámara, modelo OBJ sobre el marcador y overlay ---
+// La implementación vive en src/ARRenderer.cc (biblioteca ar_renderer), compilada
+// una vez e instanciada explícitamente para cada política de arriba.
+template <typename ObjectPolicy>
+class ARRenderer {
+public:
+    ARRenderer();
+    ~ARRenderer() { cleanup(); }
+
+    ARRenderer(const ARRenderer&) = delete;
+    ARRenderer& operator=(const ARRenderer&) = delete;
+
+    // visible = false crea una ventana oculta (contexto para render fuera de pantalla).
+    bool init(int width, int height, const std::string& title, bool visible = true);
+
+    bool loadModel(const std::string& objPath, const std::string& mtlBasePath);
+    // Parte de CPU de loadModel(): lee el OBJ, arma los vértices y prepara la textura.
+    // No toca GL, así que puede correr en otro hilo mientras se crea la ventana.
+    bool parseModel(const std::string& objPath, const std::string& mtlBasePath, ModelData& data,
+                    bool compressTextures = true) const;
+    // Parte de GL de loadModel(); requiere el contexto activo.
+    bool uploadModel(ModelData& data);
+
+    // Cambio de modelo en caliente sin detener el render: el OBJ se parsea en un hilo
+    // de trabajo, execute() lo sube por partes en el segundo juego de buffers y lo
+    // activa al empezar un fotograma. Los buffers anteriores se borran cuando la GPU
+    // terminó con ellos (fence). false si ya hay un cambio en curso.
+    bool requestModelSwap(const std::string& objPath, const std::string& mtlBasePath);
+    bool modelSwapInProgress() const { return swapState != SwapState::Idle; }
+    // Bytes de vértices que se suben por fotograma durante un cambio.
+    void setSwapUploadBudget(size_t bytesPerFrame) { swapUploadBudget = std::max<size_t>(64 * 1024, bytesPerFrame); }
+
+    // Tecla pulsada en el último sondeo de eventos (códigos de GLFW; las letras son su
+    // ASCII en mayúscula). Las que nadie consulta se descartan en el sondeo siguiente.
+    bool consumeKeyPress(int key);
+
+    // Graba los comandos del fotograma. No llama a GL, así que puede ejecutarse en
+    // un hilo de trabajo mientras el hilo de GLFW ejecuta el fotograma anterior.
+    void buildCommands(RenderCommandList& list, cv::Size frameSize, const cv::Vec3d& rvec, const cv::Vec3d& tvec,
+                       const cv::Mat& cameraMatrix);
+    // Variante con varios marcadores: cada uno dibuja el modelo que le asigna el
+    // AssetManager (los que aún no están en la GPU se omiten este fotograma).
+    void buildCommands(RenderCommandList& list, cv::Size frameSize, const std::vector<MarkerPose>& poses,
+                       const cv::Mat& cameraMatrix);
+    // Gestor de modelos por marcador; execute() le da tiempo de GL (pump) cada fotograma.
+    void setAssetManager(AssetManager* manager) { assets = manager; }
+    // Hilo de subidas con un contexto compartido (después de init, desde el hilo
+    // principal). Los cambios en caliente suben ahí en lugar de repartirse entre
+    // fotogramas; false si no se pudo crear el contexto. Sin compilación paralela en
+    // el driver, las variantes de shader del modelo también se compilan ahí.
+    bool startUploadThread();
+    // nullptr si el hilo de subidas no está activo.
+    GpuUploader* getUploader() { return uploader.running() ? &uploader : nullptr; }
+    // Añade el contorno del marcador detectado (en píxeles de la imagen) como overlay.
+    void addMarkerOverlay(RenderCommandList& list, const std::vector<cv::Point2f>& corners, cv::Size frameSize) const;
+    // Ejecuta en el hilo de GLFW un fotograma grabado con buildCommands. Con el
+    // seguimiento de daño activo devuelve false si no dibujó nada: entonces no hay que
+    // intercambiar buffers (pollEvents() en lugar de pollEventsAndSwapBuffers()).
+    bool execute(const cv::Mat& frame, RenderCommandList& list);
+    // Solo redibuja si algo cambió respecto al último fotograma dibujado: la imagen de
+    // cámara (diferencia media de una miniatura en grises por encima de
+    // backgroundThreshold niveles), los comandos (uniformes y overlay más allá de
+    // commandEpsilon), una animación o la ventana.
+    void setDamageTracking(bool enabled, float backgroundThreshold = 2.0f, float commandEpsilon = 1e-3f);
+    void render(const cv::Mat& frame, const cv::Vec3d& rvec, const cv::Vec3d& tvec, const cv::Mat& cameraMatrix);
+
+    void setCompositeMode(CompositeMode mode);
+    void printReport() const;
+
+    // Escala del pase del modelo respecto al framebuffer (1.0 = resolución completa).
+    void setModelRenderScale(float scale);
+    float getModelRenderScale() const { return modelRenderScale; }
+
+    // Redirige la salida a un FBO del tamaño del framebuffer (ventanas ocultas,
+    // pruebas de imagen dorada y composición por lotes).
+    bool setOffscreenOutput(bool enabled);
+    // Lee la imagen compuesta (BGR, origen arriba a la izquierda como OpenCV).
+    cv::Mat readOutput() const;
+    cv::Size getFramebufferSize() const { return cv::Size(framebufferWidth(), framebufferHeight()); }
+
+    // Ajusta la ventana al tamaño real de la cámara cuando se conoce después de crearla.
+    void resizeWindow(int width, int height);
+    bool windowShouldClose();
+    // Modo de presentación, fotogramas en vuelo y late latch (después de init).
+    void setFramePacing(const FramePacer::Options& options) { pacer.configure(options); }
+    // Antes de tomar el fotograma a dibujar: espera lo que pida el ritmo (FramePacer).
+    void beginFrame() { pacer.waitForFrameStart(); }
+    void printPacingReport() const { pacer.printReport(); }
+    void pollEventsAndSwapBuffers();
+    // Para fotogramas omitidos: avisa al FramePacer de que no hubo intercambio.
+    void pollEvents();
+    const RendererStats& getStats();
+    void triggerAnimation();
+    void cleanup();
+
+private:
+    GLFWwindow* window = nullptr;
+    std::atomic<int> fbWidth{0}, fbHeight{0};
+    GLuint backgroundShaderProgram = 0, upscaleShaderProgram = 0, overlayShaderProgram = 0;
+    GLuint backgroundVAO = 0, backgroundVBO = 0, backgroundTexture = 0;
+    GLuint overlayVAO = 0, overlayVBO = 0;
+    int backgroundWidth = 0, backgroundHeight = 0; // tamaño actual de backgroundTexture
+    cv::Mat backgroundResized, backgroundScratch;  // se reutilizan entre fotogramas
+    TimingStats backgroundPrepareTimes;
+    size_t overlayBufferBytes = 0;
+
+    // Variantes del shader del modelo; la básica decide en tiempo de ejecución.
+    enum ObjectShaderFeature : uint32_t {
+        ShaderDiffuseTexture = 1 << 0, // color de la textura, sin rama por useTexture
+        ShaderDiffuseColor = 1 << 1,   // color del material, sin muestrear
+        ShaderUniformScale = 1 << 2,   // matriz normal sin inverse() por vértice
+    };
+    enum ObjectUniform {
+        ObjectUniformProjection, ObjectUniformView, ObjectUniformModel,
+        ObjectUniformObjectColor, ObjectUniformLightColor, ObjectUniformLightPos, ObjectUniformViewPos,
+        ObjectUniformUseTexture, ObjectUniformDiffuseTexture,
+    };
+    ShaderPermutations objectShaders;
+    bool objectShaderVariantsRequested = false;
+
+    RenderCommandList frameCommands;
+    TimingStats buildTimes, executeTimes;
+
+    // Dos juegos de buffers: el activo y el que se sube o se retira en un cambio en
+    // caliente. buildCommands lee el activo desde el hilo de trabajo.
+    Model models[2];
+    std::atomic<int> activeModel{0};
+    TextureCache textureCache;
+
+    enum class SwapState { Idle, Parsing, Uploading };
+    SwapState swapState = SwapState::Idle;
+    std::unique_ptr<ModelData> swapData;
+    std::future<bool> swapParsed;
+    std::chrono::steady_clock::time_point swapStart;
+    size_t swapUploadedBytes = 0;
+    size_t swapUploadBudget = 1024 * 1024;
+    int swapUploadFrames = 0;
+    int retiringModel = -1;     // índice en models pendiente de borrar
+    GLsync retireFence = nullptr;
+    GpuUploader uploader;
+    FramePacer pacer;
+    GpuUploader::Ticket swapTicket = 0; // subida del cambio en el hilo de subidas (0: ninguna)
+
+    std::vector<int> pressedKeys; // del último sondeo de eventos
+
+    bool damageTracking = false;
+    float damageBackgroundThreshold = 2.0f;
+    float damageCommandEpsilon = 1e-3f;
+    cv::Mat lastDrawnThumbnail;          // miniatura en grises del último fondo dibujado
+    RenderCommandList lastDrawnCommands; // sin assetRefs
+    std::atomic<bool> windowDamaged{true}; // lo marcan los callbacks de GLFW
+    AssetManager* assets = nullptr;
+
+    float modelRenderScale = 1.0f;
+    OffscreenFramebuffer modelTarget;
+    OffscreenFramebuffer outputTarget;
+    bool renderToOffscreen = false;
+
+    CompositeMode compositeMode = CompositeMode::FillRate;
+    cv::Rect depthDirtyRect;       // en el FBO propio, zona donde la profundidad puede ser < 1 (vacía: ya limpia)
+    double currentClearedPixels = 0.0;
+    GLuint timeQueries[2] = {0, 0}, sampleQueries[2] = {0, 0};
+    bool queryPending[2] = {false, false};
+    CompositeMode queryMode[2] = {CompositeMode::Legacy, CompositeMode::Legacy};
+    unsigned long long queryFrame = 0;
+    RendererStats stats;
+
+    bool animationActive = false;
+    float animationStartTime = 0.0f;
+    bool animationApplied = false; // la local del objeto tiene una traslación de animación
+
+    SceneGraph sceneGraph;
+    SceneGraph::NodeId anchorNode = SceneGraph::invalidNode;
+    SceneGraph::NodeId objectNode = SceneGraph::invalidNode;
+    SceneGraph::NodeId submeshNode = SceneGraph::invalidNode;
+
+    struct ModelTransforms {
+        glm::mat4 projection = glm::mat4(1.0f);
+        glm::mat4 view = glm::mat4(1.0f);
+        glm::mat4 model = glm::mat4(1.0f);
+    };
+
+    void pumpModelSwap(const RenderCommandList& list);
+    void activateSwappedModel(int active, size_t vertexBytes);
+    unsigned computeDamage(const cv::Mat& frame, const RenderCommandList& list, cv::Mat& thumbnail);
+    void beginRecording(RenderCommandList& list);
+    void setModelRect(RenderCommandList& list, const cv::Rect& rect);
+
+    void updateAnimationNode();
+    ModelTransforms computeModelTransforms(cv::Size frameSize, const cv::Vec3d& rvec, const cv::Vec3d& tvec,
+                                           const cv::Mat& cameraMatrix);
+    void requestObjectShaderVariants();
+    void recordModel(RenderCommandList& list, const Model& model, const ModelTransforms& t) const;
+    void drawModelReducedResolution(const RenderCommandList& list);
+    void renderFillRateOrder(const cv::Mat& frame, const RenderCommandList& list);
+    cv::Rect projectedModelRect(const Model& model, const ModelTransforms& t) const;
+    void bindOutputFramebuffer();
+    void onFramebufferResize(int w, int h);
+
+    // El tamaño lo escribe el callback de GLFW y lo leen los hilos que graban comandos.
+    int framebufferWidth() const { return fbWidth.load(std::memory_order_relaxed); }
+    int framebufferHeight() const { return fbHeight.load(std::memory_order_relaxed); }
+    cv::Rect fullFramebufferRect() const { return cv::Rect(0, 0, framebufferWidth(), framebufferHeight()); }
+
+    void beginCompositeTiming(CompositeMode mode);
+    void endCompositeTiming(CompositeMode mode);
+    GLuint createShaderProgram(const char* vsSource, const char* fsSource);
+    void setupBackground();
+    const cv::Mat& prepareBackground(const cv::Mat& frame);
+    void drawBackground(const cv::Mat& frame, float depth);
+    void setupOverlay();
+    void drawOverlay(const RenderCommandList& list);
+    glm::mat4 buildProjectionMatrix(const cv::Mat& cameraMatrix, int screen_width, int screen_height, float near,
+                                    float far);
+    glm::mat4 buildViewMatrix(const cv::Vec3d& rvec, const cv::Vec3d& tvec);
+};
+
+extern template class ARRenderer<AnimatedModelPolicy>;
+extern template class ARRenderer<StaticModelPolicy>;
+
+using ARObjectRenderer = ARRenderer<AnimatedModelPolicy>;
+using ARCubeRenderer = ARRenderer<StaticModelPolicy>;
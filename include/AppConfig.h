@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <ARRenderer.h>
+
+// Cómo se reparte el trabajo de cada fotograma entre hilos.
+enum class PipelineMode {
+    Serial,    // captura, detección, grabación y ejecución en el hilo de GLFW
+    Pipelined, // un hilo de trabajo captura, detecta y graba comandos; GLFW solo ejecuta
+    LatestFrameWins // como Pipelined, pero el hilo de trabajo nunca espera: descarta
+                    // el fotograma listo más antiguo si GLFW aún no lo consumió
+};
+
+// --- Opciones de ejecución de la aplicación (línea de comandos) ---
+struct AppConfig {
+    float modelRenderScale = 1.0f; // escala del pase del modelo (p. ej. 0.5 en nodos sin GPU)
+
+    CompositeMode compositeMode = CompositeMode::FillRate;
+    PipelineMode pipelineMode = PipelineMode::Pipelined;
+    int latencyTestFrames = 0; // > 0: mide la latencia con una fuente sintética y termina
+    std::string startupTracePath = "startup_trace.json"; // traza del arranque en frío
+    std::string inputPath;  // video en lugar de la cámara
+    bool headless = false;  // sin ventana: solo detección y pose
+    int decodeThreads = 0;  // hilos de decodificación de --input (0 = núcleos disponibles)
+    int visionReduction = 1; // 2, 4 u 8: entradas JPEG decodificadas reducidas para la visión
+    std::string recordPath;  // graba los fotogramas como MJPEG crudo
+    std::string poseLogPath; // registra la pose de cada fotograma en CSV
+    bool directIo = false;   // O_DIRECT para la grabación
+    bool dynamicVisionPipeline = false; // --headless con etapas de visión elegidas en ejecución
+    std::vector<std::string> swapModelPaths; // modelos alternativos (tecla M los recorre)
+    std::string assetManifestPath; // modelo por ID de marcador: manifiesto o paquete de asset_packer
+    int gpuBudgetMb = 256;         // memoria de GPU para los modelos del manifiesto
+    bool uploadThread = true;      // subidas a la GPU en un contexto compartido
+    bool alwaysRedraw = false;     // redibuja cada fotograma aunque nada haya cambiado
+    double idleAfterSeconds = 0.0; // > 0: modo reposo tras tantos segundos sin cambios
+    double idleFps = 4.0;          // ritmo de captura en reposo
+    FramePacer::Options pacing;    // --pacing, --pacing-fps, --max-frames-in-flight, --late-latch
+    int numaNode = -1;             // nodo NUMA del pipeline (NumaPlacement: -1 ninguno, -2 el de la cámara)
+
+    bool helpRequested = false;
+
+    static void printUsage(const char* program) {
+        std::cout << "Uso: " << program << " [opciones]\n"
+                  << "  --model-scale <f>   Renderiza el modelo a esta escala y lo reescala (0.1 - 1.0)\n"
+                  << "  --composite <modo>  Orden de composición: fillrate (por defecto) o legacy\n"
+                  << "  --pipeline <modo>   Reparto entre hilos: pipelined (por defecto), serial o latest\n"
+                  << "  --latency-test <n>  Mide la latencia captura-pantalla con n fotogramas por modo\n"
+                  << "  --startup-trace <f> Archivo de la traza de arranque (por defecto startup_trace.json)\n"
+                  << "  --input <video>     Procesa un video en lugar de la cámara\n"
+                  << "  --decode-threads <n> Hilos que decodifican segmentos de --input (0 = todos los núcleos)\n"
+                  << "  --headless          Sin ventana: solo detección y pose, lo más rápido posible\n"
+                  << "  --vision-reduction <n> Decodifica entradas JPEG a 1/n (2, 4 u 8) para la visión\n"
+                  << "  --record <f.mjpeg>  Graba los fotogramas (reproducible con --input)\n"
+                  << "  --pose-log <f.csv>  Registra la pose de cada fotograma\n"
+                  << "  --direct-io         Graba con O_DIRECT, sin pasar por la caché de páginas\n"
+                  << "  --dynamic-vision    Con --headless, usa el pipeline de visión configurable en ejecución\n"
+                  << "  --swap-model <obj>  Modelo alternativo; la tecla M lo carga en caliente (repetible)\n"
+                  << "  --assets <f>        Manifiesto 'ID modelo.obj' o paquete de asset_packer: un modelo por marcador\n"
+                  << "  --gpu-budget-mb <n> Memoria de GPU para los modelos de --assets (por defecto 256)\n"
+                  << "  --no-upload-thread  Sube modelos y texturas en el hilo de render, sin contexto compartido\n"
+                  << "  --always-redraw     Redibuja cada fotograma aunque la imagen y la pose no cambien\n"
+                  << "  --idle-after <s>    Modo reposo tras s segundos sin cambios (por defecto desactivado)\n"
+                  << "  --idle-fps <n>      Capturas por segundo en reposo (por defecto 4)\n"
+                  << "  --pacing <modo>     Presentación: vsync (por defecto), adaptive, uncapped o fixed\n"
+                  << "  --pacing-fps <n>    Fotogramas por segundo de --pacing fixed (por defecto 60)\n"
+                  << "  --max-frames-in-flight <n> Fotogramas que la GPU puede llevar por delante (0 = los del driver)\n"
+                  << "  --late-latch        Empieza cada fotograma lo más tarde posible antes del refresco\n"
+                  << "  --numa-node <n>     Ata los hilos y la memoria del pipeline al nodo n, o 'camera' al de la cámara\n"
+                  << "  --help              Muestra esta ayuda" << std::endl;
+    }
+
+    // Devuelve false si hay que terminar (ayuda o argumento inválido).
+    bool parse(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto nextValue = [&](std::string& value) {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: Falta el valor de " << arg << std::endl;
+                    return false;
+                }
+                value = argv[++i];
+                return true;
+            };
+
+            std::string value;
+            // stoi/stof/stod lanzan con valores no numéricos o fuera de rango.
+            try {
+                if (arg == "--help" || arg == "-h") {
+                    printUsage(argv[0]);
+                    helpRequested = true;
+                    return false;
+                } else if (arg == "--model-scale") {
+                    if (!nextValue(value)) return false;
+                    modelRenderScale = std::stof(value);
+                } else if (arg == "--composite") {
+                    if (!nextValue(value)) return false;
+                    if (value == "fillrate") {
+                        compositeMode = CompositeMode::FillRate;
+                    } else if (value == "legacy") {
+                        compositeMode = CompositeMode::Legacy;
+                    } else {
+                        std::cerr << "Error: Modo de composición desconocido " << value << std::endl;
+                        return false;
+                    }
+                } else if (arg == "--pipeline") {
+                    if (!nextValue(value)) return false;
+                    if (value == "pipelined") {
+                        pipelineMode = PipelineMode::Pipelined;
+                    } else if (value == "serial") {
+                        pipelineMode = PipelineMode::Serial;
+                    } else if (value == "latest") {
+                        pipelineMode = PipelineMode::LatestFrameWins;
+                    } else {
+                        std::cerr << "Error: Modo de pipeline desconocido " << value << std::endl;
+                        return false;
+                    }
+                } else if (arg == "--latency-test") {
+                    if (!nextValue(value)) return false;
+                    latencyTestFrames = std::stoi(value);
+                } else if (arg == "--startup-trace") {
+                    if (!nextValue(startupTracePath)) return false;
+                } else if (arg == "--input") {
+                    if (!nextValue(inputPath)) return false;
+                } else if (arg == "--decode-threads") {
+                    if (!nextValue(value)) return false;
+                    decodeThreads = std::stoi(value);
+                } else if (arg == "--headless") {
+                    headless = true;
+                } else if (arg == "--record") {
+                    if (!nextValue(recordPath)) return false;
+                } else if (arg == "--pose-log") {
+                    if (!nextValue(poseLogPath)) return false;
+                } else if (arg == "--direct-io") {
+                    directIo = true;
+                } else if (arg == "--dynamic-vision") {
+                    dynamicVisionPipeline = true;
+                } else if (arg == "--assets") {
+                    if (!nextValue(assetManifestPath)) return false;
+                } else if (arg == "--no-upload-thread") {
+                    uploadThread = false;
+                } else if (arg == "--always-redraw") {
+                    alwaysRedraw = true;
+                } else if (arg == "--idle-after") {
+                    if (!nextValue(value)) return false;
+                    idleAfterSeconds = std::max(0.0, std::stod(value));
+                } else if (arg == "--idle-fps") {
+                    if (!nextValue(value)) return false;
+                    idleFps = std::max(0.5, std::stod(value));
+                } else if (arg == "--pacing") {
+                    if (!nextValue(value)) return false;
+                    if (!FramePacer::parseMode(value, pacing.mode)) {
+                        std::cerr << "Error: Modo de presentación desconocido " << value << std::endl;
+                        return false;
+                    }
+                } else if (arg == "--pacing-fps") {
+                    if (!nextValue(value)) return false;
+                    pacing.fixedFps = std::max(1.0, std::stod(value));
+                } else if (arg == "--max-frames-in-flight") {
+                    if (!nextValue(value)) return false;
+                    pacing.maxFramesInFlight = std::max(0, std::stoi(value));
+                } else if (arg == "--late-latch") {
+                    pacing.lateLatch = true;
+                } else if (arg == "--numa-node") {
+                    if (!nextValue(value)) return false;
+                    numaNode = value == "camera" ? -2 : std::max(0, std::stoi(value));
+                } else if (arg == "--gpu-budget-mb") {
+                    if (!nextValue(value)) return false;
+                    gpuBudgetMb = std::max(1, std::stoi(value));
+                } else if (arg == "--swap-model") {
+                    if (!nextValue(value)) return false;
+                    swapModelPaths.push_back(value);
+                } else if (arg == "--vision-reduction") {
+                    if (!nextValue(value)) return false;
+                    visionReduction = std::stoi(value);
+                    if (visionReduction != 1 && visionReduction != 2 && visionReduction != 4 && visionReduction != 8) {
+                        std::cerr << "Error: --vision-reduction debe ser 1, 2, 4 u 8" << std::endl;
+                        return false;
+                    }
+                } else {
+                    std::cerr << "Error: Opción desconocida " << arg << std::endl;
+                    printUsage(argv[0]);
+                    return false;
+                }
+            } catch (const std::exception&) {
+                std::cerr << "Error: Valor inválido para " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <ARRenderer.h>
+#include <AssetPack.h>
+#include <PerfStats.h>
+#include <TextureCache.h>
+
+// Línea del manifiesto de --assets ya resuelta.
+struct AssetManifestEntry {
+    int markerId = -1;       // -1 para '*'
+    bool isDefault = false;
+    std::string objFile;     // tal como aparece en el manifiesto
+    std::string objPath;     // relativa al directorio actual
+    std::string mtlBasePath;
+};
+
+// Manifiesto de texto, una línea por marcador ('#' para comentarios):
+//   7   modelos/rata.obj
+//   *   modelos/cubo.obj      (marcadores sin entrada propia)
+// Las rutas son relativas al manifiesto; el MTL y las texturas se buscan junto al OBJ.
+bool readAssetManifest(const std::string& path, std::vector<AssetManifestEntry>& entries);
+
+// --- Modelos por ID de marcador con presupuesto de memoria de GPU ---
+// Cada marcador apunta a un modelo (varios pueden compartir el mismo). La primera
+// vez que se ve un ID su modelo se parsea en un hilo de trabajo; pump() lo sube en
+// el hilo de GL y desaloja los menos vistos recientemente mientras la memoria de GPU
+// residente supere el presupuesto. Un modelo referenciado por una lista de comandos
+// aún sin ejecutar no se desaloja (acquire/release cuentan las referencias).
+//
+// Se construye en el hilo de GL con el contexto activo. acquire() y release() se
+// pueden llamar desde el hilo que graba comandos; pump() y releaseAll() solo desde
+// el hilo de GL. Con setUploader() los VBO y texturas se
+// crean en el hilo de subidas y pump() no bloquea el fotograma con glBufferData.
+class AssetManager {
+public:
+    struct Options {
+        size_t gpuBudgetBytes = 256 * 1024 * 1024;
+        int loaderThreads = 2;
+        int uploadsPerFrame = 1; // modelos que pump() sube como máximo por fotograma
+    };
+
+    struct Stats {
+        long long loads = 0;
+        long long evictions = 0;
+        long long failures = 0;
+        size_t residentBytes = 0;
+        size_t peakResidentBytes = 0;
+        int residentAssets = 0;
+    };
+
+    AssetManager() : AssetManager(Options()) {}
+    explicit AssetManager(const Options& options);
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Ver readAssetManifest().
+    bool loadManifest(const std::string& path);
+    // Paquete de asset_packer: los modelos se toman del archivo proyectado sin
+    // parsear nada, con la misma asignación de marcadores que su manifiesto.
+    bool loadPack(const std::string& path);
+    void map(int markerId, const std::string& objPath, const std::string& mtlBasePath);
+    void mapDefault(const std::string& objPath, const std::string& mtlBasePath);
+
+    // Modelo del marcador si ya está en la GPU; si no, pide su carga y devuelve false.
+    // Con éxito suma una referencia (ref) que hay que devolver con release().
+    bool acquire(int markerId, Model& model, uint32_t& ref);
+    void release(std::vector<uint32_t>& refs);
+
+    // Con hilo de subidas, pump() solo encola y recoge las subidas terminadas.
+    void setUploader(GpuUploader* gpuUploader) { uploader = gpuUploader; }
+
+    // Sube los modelos ya parseados y desaloja hasta volver al presupuesto.
+    void pump();
+    // Borra todos los objetos GL (antes de destruir el contexto).
+    void releaseAll();
+
+    Stats stats() const;
+    void printReport() const;
+
+private:
+    enum class AssetState { Unloaded, Loading, Parsed, Uploading, Resident, Failed };
+
+    // Lo que el hilo de subidas deja listo; el VAO se arma al recogerlo.
+    struct PendingUpload {
+        Model model;
+        size_t gpuBytes = 0;
+    };
+
+    struct Asset {
+        std::string objPath, mtlBasePath;
+        uint32_t packAsset = UINT32_MAX; // índice en el paquete si viene de él
+        bool verified = false;           // suma del paquete ya comprobada
+        AssetState state = AssetState::Unloaded;
+        Model model;
+        size_t gpuBytes = 0;
+        int refs = 0;
+        uint64_t lastSeen = 0;
+        std::unique_ptr<ModelData> data;
+        std::shared_ptr<PendingUpload> upload;
+        GpuUploader::Ticket uploadTicket = 0;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    Options options;
+    TextureCache textureCache;
+    AssetPack pack;
+    GpuUploader* uploader = nullptr;
+    bool compressTextures; // S3TC, consultado al construir: los cargadores no tienen contexto
+
+    mutable std::mutex mutex;
+    std::condition_variable loadRequested;
+    std::vector<Asset> assets;
+    std::unordered_map<std::string, uint32_t> assetByPath;
+    std::unordered_map<int, uint32_t> assetByMarker;
+    uint32_t defaultAsset = UINT32_MAX;
+    std::deque<uint32_t> loadQueue;
+    uint64_t seenClock = 0;
+    bool stopping = false;
+    std::vector<std::thread> loaders;
+
+    Stats counters;
+    TimingStats loadTimes;  // desde el primer avistamiento hasta quedar residente
+    TimingStats evictTimes; // borrado de los objetos GL de un modelo
+
+    uint32_t assetFor(const std::string& objPath, const std::string& mtlBasePath);
+    void loaderLoop();
+    size_t uploadPacked(uint32_t packAsset, Model& model);
+    void finishUploads();
+    void makeResident(uint32_t index, const PendingUpload& upload);
+    void evictOverBudget();
+};
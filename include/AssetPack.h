@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// --- Paquete de modelos en un solo archivo, listo para la GPU ---
+// Lo genera asset_packer a partir del manifiesto de --assets. Todo se guarda tal
+// como se sube: vértices intercalados (8 floats, igual que parseObjModel) y la
+// cadena de mips S3TC de la textura difusa, sin texto que parsear. El archivo se
+// proyecta entero con un solo mmap; cargar un modelo es tomar punteros dentro de
+// él, y el kernel lee sus páginas la primera vez que se tocan.
+//
+// Disposición (enteros en el orden de bytes de la máquina que lo generó):
+//   AssetPackHeader
+//   por modelo, alineado a página: vértices, y cada mip alineado a 16 bytes
+//   índice: AssetPackEntry[assetCount], AssetPackMip[mipCount], AssetPackMarker[markerCount]
+// El índice va al final para escribir el archivo en una sola pasada.
+struct AssetPackHeader {
+    char magic[8];          // "RATPACK\0"
+    uint32_t version;
+    uint32_t assetCount;
+    uint32_t mipCount;      // total de AssetPackMip en el índice
+    uint32_t markerCount;
+    uint64_t indexOffset;
+    uint64_t fileSize;
+    uint64_t indexChecksum; // de todo el índice
+};
+
+// Un modelo y su material (el renderizador dibuja un solo material por modelo).
+struct AssetPackEntry {
+    char name[64];          // ruta del OBJ relativa al manifiesto, terminada en '\0'
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint32_t vertexCount;
+    uint32_t textureFormat; // GL_COMPRESSED_*_S3TC_*, 0 si no tiene textura
+    uint32_t firstMip;      // índice en la tabla de mips
+    uint32_t mipLevels;
+    float boundsMin[3];
+    float boundsMax[3];
+    float diffuseColor[3];
+    uint32_t reserved;
+    uint64_t checksum;      // de los vértices y los mips, en ese orden
+};
+
+struct AssetPackMip {
+    uint32_t width, height;
+    uint64_t offset, bytes;
+};
+
+// Marcador -> modelo; markerId == -1 es el modelo por defecto ('*' en el manifiesto).
+struct AssetPackMarker {
+    int32_t markerId;
+    uint32_t asset;
+};
+
+class AssetPack {
+public:
+    static constexpr char magic[8] = {'R', 'A', 'T', 'P', 'A', 'C', 'K', '\0'};
+    static constexpr uint32_t version = 1;
+    static constexpr uint64_t pageAlignment = 4096;
+    static constexpr uint64_t mipAlignment = 16;
+
+    AssetPack() = default;
+    ~AssetPack() { close(); }
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // true si el archivo empieza con la firma del paquete.
+    static bool isPack(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        char head[sizeof(magic)] = {};
+        const bool match = ::read(fd, head, sizeof(head)) == (ssize_t)sizeof(head) &&
+                           std::memcmp(head, magic, sizeof(magic)) == 0;
+        ::close(fd);
+        return match;
+    }
+
+    // Proyecta el archivo y valida la cabecera y el índice. Las cargas de modelos no
+    // leen nada más del disco que las páginas de ese modelo.
+    bool open(const std::string& path) {
+        close();
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Error: No se pudo abrir el paquete de modelos " << path << std::endl;
+            return false;
+        }
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(AssetPackHeader)) {
+            std::cerr << "Error: Paquete de modelos vacío o ilegible: " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // la proyección sigue válida sin el descriptor
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: mmap falló para " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        base = static_cast<const uint8_t*>(mapped);
+        size = (size_t)info.st_size;
+
+        if (!validateIndex()) {
+            std::cerr << "Error: Paquete de modelos corrupto o de otra versión: " << path << std::endl;
+            close();
+            return false;
+        }
+        // El índice se lee entero al abrir; los datos, a demanda.
+        madvise(const_cast<uint8_t*>(base), size, MADV_RANDOM);
+        for (uint32_t i = 0; i < header().assetCount; ++i) assetByName[entry(i).name] = i;
+        return true;
+    }
+
+    void close() {
+        if (base) munmap(const_cast<uint8_t*>(base), size);
+        base = nullptr;
+        size = 0;
+        assetByName.clear();
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    size_t fileSize() const { return size; }
+
+    const AssetPackHeader& header() const { return *reinterpret_cast<const AssetPackHeader*>(base); }
+    uint32_t assetCount() const { return header().assetCount; }
+    const AssetPackEntry& entry(uint32_t asset) const { return entries()[asset]; }
+    const AssetPackMip& mip(const AssetPackEntry& entry, uint32_t level) const {
+        return mips()[entry.firstMip + level];
+    }
+    uint32_t markerCount() const { return header().markerCount; }
+    const AssetPackMarker& marker(uint32_t i) const { return markers()[i]; }
+
+    // Índice del modelo con ese nombre o UINT32_MAX.
+    uint32_t find(const std::string& name) const {
+        auto it = assetByName.find(name);
+        return it != assetByName.end() ? it->second : UINT32_MAX;
+    }
+
+    const float* vertices(const AssetPackEntry& entry) const {
+        return reinterpret_cast<const float*>(base + entry.vertexOffset);
+    }
+    const uint8_t* mipData(const AssetPackMip& mip) const { return base + mip.offset; }
+
+    // Pide al kernel que adelante la lectura de las páginas del modelo.
+    void prefetch(const AssetPackEntry& entry) const {
+        const uint64_t begin = entry.vertexOffset & ~(pageAlignment - 1);
+        uint64_t end = entry.vertexOffset + entry.vertexBytes;
+        if (entry.mipLevels > 0) {
+            const AssetPackMip& last = mip(entry, entry.mipLevels - 1);
+            end = last.offset + last.bytes;
+        }
+        madvise(const_cast<uint8_t*>(base + begin), end - begin, MADV_WILLNEED);
+    }
+
+    // Recalcula la suma de los datos del modelo; toca todas sus páginas, así que
+    // conviene hacerlo fuera del hilo de GL.
+    bool verify(uint32_t asset) const {
+        const AssetPackEntry& e = entry(asset);
+        uint64_t hash = checksum(base + e.vertexOffset, e.vertexBytes);
+        for (uint32_t level = 0; level < e.mipLevels; ++level) {
+            const AssetPackMip& m = mip(e, level);
+            hash = checksum(base + m.offset, m.bytes, hash);
+        }
+        return hash == e.checksum;
+    }
+
+    // FNV-1a de 64 bits, encadenable con seed.
+    static uint64_t checksum(const void* data, size_t bytes, uint64_t seed = 0xcbf29ce484222325ull) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        uint64_t hash = seed;
+        for (size_t i = 0; i < bytes; ++i) {
+            hash ^= p[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    static uint64_t indexBytes(const AssetPackHeader& h) {
+        return (uint64_t)h.assetCount * sizeof(AssetPackEntry) + (uint64_t)h.mipCount * sizeof(AssetPackMip) +
+               (uint64_t)h.markerCount * sizeof(AssetPackMarker);
+    }
+
+private:
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    std::unordered_map<std::string, uint32_t> assetByName;
+
+    const AssetPackEntry* entries() const {
+        return reinterpret_cast<const AssetPackEntry*>(base + header().indexOffset);
+    }
+    const AssetPackMip* mips() const {
+        return reinterpret_cast<const AssetPackMip*>(entries() + header().assetCount);
+    }
+    const AssetPackMarker* markers() const {
+        return reinterpret_cast<const AssetPackMarker*>(mips() + header().mipCount);
+    }
+
+    // Comprueba que todo lo que el índice apunta cae dentro del archivo, para que un
+    // paquete truncado falle al abrirlo y no al leer un modelo.
+    bool validateIndex() const {
+        const AssetPackHeader& h = header();
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version || h.fileSize != size)
+            return false;
+        if (h.indexOffset % alignof(AssetPackEntry) != 0 || h.indexOffset > size ||
+            indexBytes(h) > size - h.indexOffset)
+            return false;
+        if (checksum(base + h.indexOffset, indexBytes(h)) != h.indexChecksum) return false;
+
+        auto inFile = [this](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+        for (uint32_t i = 0; i < h.assetCount; ++i) {
+            const AssetPackEntry& e = entry(i);
+            if (e.name[sizeof(e.name) - 1] != '\0' || !inFile(e.vertexOffset, e.vertexBytes) ||
+                e.vertexOffset % alignof(float) != 0 || e.vertexBytes != (uint64_t)e.vertexCount * 8 * sizeof(float) ||
+                (uint64_t)e.firstMip + e.mipLevels > h.mipCount)
+                return false;
+            for (uint32_t level = 0; level < e.mipLevels; ++level) {
+                const AssetPackMip& m = mip(e, level);
+                if (!inFile(m.offset, m.bytes)) return false;
+            }
+        }
+        for (uint32_t i = 0; i < h.markerCount; ++i) {
+            if (marker(i).asset >= h.assetCount) return false;
+        }
+        return true;
+    }
+};
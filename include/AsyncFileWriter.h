@@ -0,0 +1,458 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <FrameChannel.h>
+#include <ResourceTracker.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define AR_HAVE_IO_URING 1
+#endif
+
+// --- Escritura asíncrona a disco compartida por grabaciones y registros ---
+// Los datos se copian a búferes alineados y preasignados (un conjunto fijo, así que
+// la memoria está acotada); cuando un búfer se llena se encola su escritura y el
+// productor sigue con otro. Si no queda ninguno libre, write() espera: el disco
+// frena al productor en lugar de crecer la memoria. Cada flujo abierto retiene un
+// búfer a medio llenar hasta que se llena o se cierra (un registro de poses ocioso
+// lo retiene indefinidamente), así que open() admite como máximo bufferCount - 1
+// flujos: siempre queda al menos uno que circula y write() no se bloquea para siempre.
+//
+// El hilo de E/S usa io_uring (llamadas al sistema directas, sin liburing) con los
+// búferes registrados (IORING_OP_WRITE_FIXED) y envía en lotes todo lo pendiente con
+// un solo io_uring_enter. Si el kernel no lo permite (seccomp, kernel viejo) se usa un
+// grupo de hilos con pwrite. Con O_DIRECT el último búfer se rellena hasta la
+// alineación y el archivo se trunca a su longitud real al cerrarlo.
+class AsyncFileWriter {
+public:
+    struct Options {
+        size_t bufferSize = 512 * 1024; // múltiplo de alignment
+        int bufferCount = 8;
+        int fallbackThreads = 2;
+        bool useIoUring = true;
+    };
+
+    struct Stats {
+        long long bytesWritten = 0;
+        long long writes = 0;
+        long long batches = 0;     // io_uring_enter con envíos (o escrituras del respaldo)
+        long long bufferWaits = 0; // veces que write() esperó un búfer libre
+        long long errors = 0;
+    };
+
+    static constexpr size_t alignment = 4096;
+
+    AsyncFileWriter() : AsyncFileWriter(Options()) {}
+    explicit AsyncFileWriter(const Options& options)
+        : options(options), freeBuffers(options.bufferCount), requests(options.bufferCount) {
+        this->options.bufferSize = std::max(alignment, (options.bufferSize + alignment - 1) / alignment * alignment);
+        buffers.resize(options.bufferCount);
+        for (int i = 0; i < options.bufferCount; ++i) {
+            buffers[i] = static_cast<uint8_t*>(std::aligned_alloc(alignment, this->options.bufferSize));
+            freeBuffers.push(i);
+        }
+        trackedBytes.set(this->options.bufferSize * options.bufferCount);
+        inFlightRequests.resize(options.bufferCount);
+
+#ifdef AR_HAVE_IO_URING
+        if (options.useIoUring && ring.setup((unsigned)options.bufferCount, buffers, this->options.bufferSize)) {
+            backend = ring.fixedBuffers ? "io_uring (búferes registrados)" : "io_uring";
+            workers.emplace_back([this] { ringLoop(); });
+            return;
+        }
+#endif
+        backend = "hilos con pwrite";
+        for (int i = 0; i < std::max(1, options.fallbackThreads); ++i)
+            workers.emplace_back([this] { fallbackLoop(); });
+    }
+
+    ~AsyncFileWriter() {
+        for (int stream = 0; stream < (int)streams.size(); ++stream) close(stream);
+        requests.close();
+        for (std::thread& worker : workers) worker.join();
+#ifdef AR_HAVE_IO_URING
+        ring.destroy();
+#endif
+        for (uint8_t* buffer : buffers) std::free(buffer);
+    }
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // Devuelve el identificador del flujo o -1. Si O_DIRECT no está disponible en el
+    // sistema de archivos (tmpfs, p. ej.) se abre sin él.
+    int open(const std::string& path, bool direct = false) {
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            if (openStreams + 1 >= options.bufferCount) {
+                std::cerr << "Error: No se puede abrir " << path << ": " << options.bufferCount
+                          << " búferes admiten como máximo " << options.bufferCount - 1 << " flujos abiertos"
+                          << std::endl;
+                return -1;
+            }
+            openStreams++; // reservado antes de abrir para que otro open() no lo tome
+        }
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        int fd = -1;
+        if (direct) {
+            fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            if (fd < 0) {
+                std::cerr << "Aviso: O_DIRECT no disponible para " << path << ", se usa E/S con caché" << std::endl;
+                direct = false;
+            }
+        }
+        if (fd < 0) fd = ::open(path.c_str(), flags, 0644);
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (fd < 0) {
+            openStreams--;
+            std::cerr << "Error: No se pudo abrir " << path << " para escritura" << std::endl;
+            return -1;
+        }
+        auto stream = std::make_unique<Stream>();
+        stream->fd = fd;
+        stream->direct = direct;
+        streams.push_back(std::move(stream));
+        return (int)streams.size() - 1;
+    }
+
+    // Copia los datos al búfer actual del flujo. Un flujo no debe usarse desde
+    // varios hilos a la vez; flujos distintos sí.
+    bool write(int id, const void* data, size_t size) {
+        Stream* stream = streamAt(id);
+        if (!stream || stream->fd < 0) return false;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0) {
+            if (stream->buffer < 0 && !acquireBuffer(*stream)) return false;
+            const size_t chunk = std::min(size, options.bufferSize - stream->fill);
+            std::memcpy(buffers[stream->buffer] + stream->fill, bytes, chunk);
+            stream->fill += chunk;
+            bytes += chunk;
+            size -= chunk;
+            if (stream->fill == options.bufferSize) submit(id, *stream, options.bufferSize);
+        }
+        return true;
+    }
+
+    bool write(int id, const std::string& text) {
+        return write(id, text.data(), text.size());
+    }
+
+    // Vacía lo pendiente, espera a que termine en disco y cierra el archivo.
+    void close(int id) {
+        Stream* stream = streamAt(id);
+        if (!stream || stream->fd < 0) return;
+        if (stream->buffer >= 0 && stream->fill > 0) {
+            size_t length = stream->fill;
+            if (stream->direct) {
+                const size_t padded = (length + alignment - 1) / alignment * alignment;
+                std::memset(buffers[stream->buffer] + length, 0, padded - length);
+                length = padded;
+            }
+            const off_t logicalSize = stream->offset + (off_t)stream->fill;
+            submit(id, *stream, length);
+            stream->logicalSize = logicalSize;
+        } else if (stream->buffer >= 0) {
+            freeBuffers.push(stream->buffer);
+            stream->buffer = -1;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(streamMutex);
+            streamIdle.wait(lock, [&] { return stream->inFlight == 0; });
+        }
+        if (stream->direct && stream->logicalSize >= 0 && ftruncate(stream->fd, stream->logicalSize) != 0)
+            std::cerr << "Error: No se pudo truncar el archivo al cerrarlo" << std::endl;
+        ::close(stream->fd);
+        stream->fd = -1;
+        std::lock_guard<std::mutex> lock(streamMutex);
+        openStreams--;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        return totals;
+    }
+
+    const char* backendName() const { return backend; }
+    size_t bufferBytes() const { return options.bufferSize * options.bufferCount; }
+
+private:
+    struct Stream {
+        int fd = -1;
+        bool direct = false;
+        int buffer = -1;      // búfer que se está llenando
+        size_t fill = 0;
+        off_t offset = 0;     // posición del siguiente búfer enviado
+        off_t logicalSize = -1;
+        int inFlight = 0;     // protegido por streamMutex
+    };
+
+    struct WriteRequest {
+        int stream = -1;
+        int fd = -1;
+        int buffer = -1;
+        size_t length = 0;
+        size_t done = 0;
+        off_t offset = 0;
+    };
+
+    Options options;
+    const char* backend = "";
+    std::vector<uint8_t*> buffers;
+    FrameChannel<int> freeBuffers;
+    FrameChannel<WriteRequest> requests;
+    std::vector<WriteRequest> inFlightRequests; // indexado por búfer
+    std::vector<std::thread> workers;
+    TrackedAllocation trackedBytes{ResourceCategory::IoBuffers};
+
+    std::mutex streamMutex;
+    std::condition_variable streamIdle;
+    std::vector<std::unique_ptr<Stream>> streams;
+    int openStreams = 0;
+
+    mutable std::mutex statsMutex;
+    Stats totals;
+
+    Stream* streamAt(int id) {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        return id >= 0 && id < (int)streams.size() ? streams[id].get() : nullptr;
+    }
+
+    bool acquireBuffer(Stream& stream) {
+        if (!freeBuffers.tryPop(stream.buffer)) {
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                totals.bufferWaits++;
+            }
+            if (!freeBuffers.pop(stream.buffer)) return false;
+        }
+        stream.fill = 0;
+        return true;
+    }
+
+    void submit(int id, Stream& stream, size_t length) {
+        WriteRequest request;
+        request.stream = id;
+        request.fd = stream.fd;
+        request.buffer = stream.buffer;
+        request.length = length;
+        request.offset = stream.offset;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            stream.inFlight++;
+        }
+        stream.offset += (off_t)length;
+        stream.buffer = -1;
+        stream.fill = 0;
+        requests.push(request);
+    }
+
+    // Escritura terminada (o fallida): el búfer vuelve a la reserva.
+    void complete(const WriteRequest& request, bool ok) {
+        {
+            std::lock_guard<std::mutex> lock(statsMutex);
+            totals.writes++;
+            if (ok) totals.bytesWritten += (long long)request.length;
+            else totals.errors++;
+        }
+        freeBuffers.push(request.buffer);
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streams[request.stream]->inFlight--;
+        streamIdle.notify_all();
+    }
+
+    void fallbackLoop() {
+        WriteRequest request;
+        while (requests.pop(request)) {
+            bool ok = true;
+            while (request.done < request.length) {
+                const ssize_t written = pwrite(request.fd, buffers[request.buffer] + request.done,
+                                               request.length - request.done, request.offset + (off_t)request.done);
+                if (written <= 0) {
+                    ok = false;
+                    break;
+                }
+                request.done += (size_t)written;
+            }
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                totals.batches++;
+            }
+            complete(request, ok);
+        }
+    }
+
+#ifdef AR_HAVE_IO_URING
+    struct Ring {
+        int fd = -1;
+        bool fixedBuffers = false;
+        unsigned entries = 0;
+        void* sqRing = nullptr;
+        void* cqRing = nullptr;
+        size_t sqRingSize = 0, cqRingSize = 0;
+        io_uring_sqe* sqes = nullptr;
+        size_t sqesSize = 0;
+        unsigned *sqHead = nullptr, *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+        unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+        io_uring_cqe* cqes = nullptr;
+
+        bool setup(unsigned depth, const std::vector<uint8_t*>& buffers, size_t bufferSize) {
+            io_uring_params params;
+            std::memset(&params, 0, sizeof(params));
+            fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+            if (fd < 0) return false;
+            entries = params.sq_entries;
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (singleMmap) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED) return fail();
+            cqRing = singleMmap ? sqRing
+                                : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) return fail();
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe*>(
+                mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+            if (sqes == MAP_FAILED) return fail();
+
+            uint8_t* sq = static_cast<uint8_t*>(sqRing);
+            sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            uint8_t* cq = static_cast<uint8_t*>(cqRing);
+            cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            // Registrar los búferes evita fijar sus páginas en cada escritura; puede
+            // fallar por RLIMIT_MEMLOCK y entonces se usa IORING_OP_WRITE normal.
+            std::vector<iovec> iovecs(buffers.size());
+            for (size_t i = 0; i < buffers.size(); ++i) iovecs[i] = {buffers[i], bufferSize};
+            fixedBuffers = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                                   (unsigned)iovecs.size()) == 0;
+            return true;
+        }
+
+        bool fail() {
+            destroy();
+            return false;
+        }
+
+        void destroy() {
+            if (sqes && sqes != MAP_FAILED) munmap(sqes, sqesSize);
+            if (cqRing && cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+            if (sqRing && sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+            if (fd >= 0) ::close(fd);
+            sqes = nullptr;
+            sqRing = cqRing = nullptr;
+            fd = -1;
+        }
+    } ring;
+
+    void queueWrite(const WriteRequest& request) {
+        const unsigned tail = *ring.sqTail;
+        const unsigned index = tail & *ring.sqMask;
+        io_uring_sqe* sqe = &ring.sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = ring.fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe->fd = request.fd;
+        sqe->off = (uint64_t)(request.offset + (off_t)request.done);
+        sqe->addr = (uint64_t)(uintptr_t)(buffers[request.buffer] + request.done);
+        sqe->len = (uint32_t)(request.length - request.done);
+        if (ring.fixedBuffers) sqe->buf_index = (uint16_t)request.buffer;
+        sqe->user_data = (uint64_t)request.buffer;
+        inFlightRequests[request.buffer] = request;
+        ring.sqArray[index] = index;
+        __atomic_store_n(ring.sqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Un solo hilo es dueño del anillo: junta todo lo pendiente, lo envía con un
+    // io_uring_enter y recoge las terminaciones. Las escrituras cortas se reenvían.
+    void ringLoop() {
+        unsigned inFlight = 0; // encoladas en el anillo y aún sin terminación
+        std::vector<char> pending(buffers.size(), 0);
+        std::deque<WriteRequest> retries;
+        auto enqueue = [&](const WriteRequest& request) {
+            queueWrite(request);
+            pending[request.buffer] = 1;
+            inFlight++;
+        };
+
+        while (true) {
+            unsigned queued = 0;
+            WriteRequest request;
+            for (; !retries.empty() && inFlight < ring.entries; ++queued) {
+                enqueue(retries.front());
+                retries.pop_front();
+            }
+            if (inFlight == 0) {
+                if (!requests.pop(request)) break;
+                enqueue(request);
+                queued++;
+            }
+            for (; inFlight < ring.entries && requests.tryPop(request); ++queued) enqueue(request);
+
+            // Lo que el kernel no consumió en una llamada interrumpida sigue en el anillo.
+            const unsigned toSubmit = *ring.sqTail - __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE);
+            const unsigned waitFor = queued == 0 ? 1 : 0;
+            const long result = syscall(__NR_io_uring_enter, ring.fd, toSubmit, waitFor,
+                                        waitFor ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                std::cerr << "Error: io_uring_enter falló (" << std::strerror(errno)
+                          << "), se continúa con pwrite" << std::endl;
+                for (size_t i = 0; i < pending.size(); ++i) {
+                    if (pending[i]) complete(inFlightRequests[i], false);
+                }
+                for (const WriteRequest& retry : retries) complete(retry, false);
+                fallbackLoop();
+                return;
+            }
+            if (toSubmit) {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                totals.batches++;
+            }
+
+            unsigned head = *ring.cqHead;
+            const unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+                WriteRequest& done = inFlightRequests[cqe.user_data];
+                pending[done.buffer] = 0;
+                inFlight--;
+                if (cqe.res > 0 && done.done + (size_t)cqe.res < done.length) {
+                    done.done += (size_t)cqe.res;
+                    retries.push_back(done);
+                } else {
+                    complete(done, cqe.res > 0);
+                }
+            }
+            __atomic_store_n(ring.cqHead, head, __ATOMIC_RELEASE);
+        }
+    }
+#endif
+};
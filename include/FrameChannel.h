@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// --- Cola acotada entre hilos para pasar fotogramas entre etapas ---
+// push bloquea mientras la cola está llena; pop bloquea mientras está vacía.
+// Tras close() los push fallan y los pop vacían lo pendiente y luego fallan.
+template <typename T>
+class FrameChannel {
+public:
+    explicit FrameChannel(size_t capacity) : capacity(capacity) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return closed || items.size() < capacity; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Variante "el último fotograma gana": si la cola está llena, descarta el más
+    // antiguo y lo devuelve en dropped para reciclarlo. Nunca bloquea.
+    bool pushLatest(T item, T& dropped) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (closed) return false;
+        if (items.size() >= capacity) {
+            dropped = std::move(items.front());
+            items.pop_front();
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Como pop, pero sin bloquear: false si no hay nada pendiente.
+    bool tryPop(T& item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+private:
+    const size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable notFull, notEmpty;
+};
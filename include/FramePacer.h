@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <deque>
+#include <string>
+
+#include <PerfStats.h>
+
+// Cómo se sincroniza el intercambio de buffers con la pantalla.
+enum class PacingMode {
+    VSync,    // intervalo 1: espera al refresco
+    Adaptive, // intervalo -1 (EXT_swap_control_tear): como VSync, pero si un fotograma
+              // llega tarde se presenta ya en lugar de esperar al siguiente refresco
+    Uncapped, // intervalo 0: presenta en cuanto termina
+    FixedRate // intervalo 0 y un reloj propio a fixedFps (p. ej. 30 en una pantalla de 60)
+};
+
+// --- Ritmo de presentación y fotogramas en vuelo ---
+// Fija el intervalo de intercambio en lugar de heredar el del driver y, con
+// maxFramesInFlight, pone un fence tras cada intercambio: antes de empezar el
+// fotograma N se espera al del N - maxFramesInFlight, así el driver no encola
+// fotogramas por delante (latencia que no se ve en ningún contador).
+//
+// Con lateLatch, waitForFrameStart() además duerme hasta el último momento que aún
+// llega al próximo refresco: la presentación prevista (el último intercambio más el
+// periodo medido, o el turno de FixedRate) menos el p95 de lo que tarda un fotograma
+// desde que empieza hasta el intercambio y latchMarginMs de holgura. El trabajo que
+// depende de la pose (tomar el paquete más reciente) empieza después. En Uncapped no
+// hay refresco al que llegar y no se espera.
+//
+// Todo en el hilo de GL, con el contexto activo.
+class FramePacer {
+public:
+    struct Options {
+        PacingMode mode = PacingMode::VSync;
+        double fixedFps = 60.0;
+        int maxFramesInFlight = 0; // 0: sin límite (lo que haga el driver)
+        bool lateLatch = false;
+        double latchMarginMs = 2.0;
+    };
+
+    FramePacer() = default;
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Aplica el modo y reinicia las estadísticas.
+    void configure(const Options& options);
+    const Options& getOptions() const { return options; }
+
+    // Antes del trabajo que depende de la pose.
+    void waitForFrameStart();
+    // Alrededor de glfwSwapBuffers.
+    void beforeSwap();
+    void afterSwap();
+    // Fotograma omitido por el seguimiento de daño (sin intercambio): el hueco hasta
+    // el próximo intercambio no es un intervalo de presentación y no se mide.
+    void frameSkipped();
+    // Borra los fences pendientes (al cerrar el contexto).
+    void release();
+
+    void printReport() const;
+
+    static const char* modeName(PacingMode mode);
+    static bool parseMode(const std::string& name, PacingMode& mode);
+
+private:
+    Options options;
+    int swapInterval = 1; // el aplicado de verdad (Adaptive cae a 1 sin la extensión)
+
+    std::deque<GLsync> inFlight;
+    std::chrono::steady_clock::time_point lastSwap, frameStart, nextSlot;
+    bool haveLastSwap = false, frameStarted = false, haveSlot = false;
+    std::deque<double> recentIntervals, recentWork; // últimos fotogramas, para predecir
+
+    TimingStats swapIntervals; // entre retornos de glfwSwapBuffers: ritmo y jitter
+    TimingStats frameWork;     // desde waitForFrameStart hasta el intercambio
+    TimingStats fenceWaits, latchWaits, slotWaits;
+    long long missedDeadlines = 0; // intervalos de más de 1,5 periodos
+    long long skippedFrames = 0;
+
+    double refreshPeriodMs() const;
+    static double recentPercentile(const std::deque<double>& values, double p);
+    static void pushRecent(std::deque<double>& values, double value);
+};
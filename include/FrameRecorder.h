@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <AsyncFileWriter.h>
+
+// --- Grabación de fotogramas como flujo MJPEG crudo (JPEGs concatenados) ---
+// Se codifica en el hilo que llama y los bytes van al AsyncFileWriter compartido,
+// así que una pausa del disco no bloquea la captura mientras queden búferes libres.
+// El archivo resultante se puede reproducir con --input (JpegFrameSource).
+class MjpegRecorder {
+public:
+    MjpegRecorder(AsyncFileWriter& writer, const std::string& path, int quality = 85, bool direct = false)
+        : writer(writer), stream(writer.open(path, direct)), params{cv::IMWRITE_JPEG_QUALITY, quality} {}
+
+    ~MjpegRecorder() { writer.close(stream); }
+
+    MjpegRecorder(const MjpegRecorder&) = delete;
+    MjpegRecorder& operator=(const MjpegRecorder&) = delete;
+
+    bool isOpened() const { return stream >= 0; }
+
+    bool write(const cv::Mat& frame) {
+        if (stream < 0 || frame.empty()) return false;
+        if (!cv::imencode(".jpg", frame, encoded, params)) return false;
+        frames++;
+        return writer.write(stream, encoded.data(), encoded.size());
+    }
+
+    long long frameCount() const { return frames; }
+
+private:
+    AsyncFileWriter& writer;
+    int stream;
+    std::vector<int> params;
+    std::vector<uchar> encoded; // se reutiliza entre fotogramas
+    long long frames = 0;
+};
+
+// --- Registro de poses en CSV: fotograma, marca de tiempo y pose del marcador ---
+class PoseLog {
+public:
+    PoseLog(AsyncFileWriter& writer, const std::string& path)
+        : writer(writer), stream(writer.open(path)) {
+        if (stream >= 0) writer.write(stream, std::string("frame,timestamp_us,found,rx,ry,rz,tx,ty,tz\n"));
+    }
+
+    ~PoseLog() { writer.close(stream); }
+
+    PoseLog(const PoseLog&) = delete;
+    PoseLog& operator=(const PoseLog&) = delete;
+
+    bool isOpened() const { return stream >= 0; }
+
+    void write(long long frame, long long timestampUs, bool found, const cv::Vec3d& rvec, const cv::Vec3d& tvec) {
+        if (stream < 0) return;
+        char line[256];
+        const int length = std::snprintf(line, sizeof(line), "%lld,%lld,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+                                         frame, timestampUs, found ? 1 : 0, rvec[0], rvec[1], rvec[2],
+                                         tvec[0], tvec[1], tvec[2]);
+        if (length > 0) writer.write(stream, line, (size_t)std::min(length, (int)sizeof(line) - 1));
+    }
+
+private:
+    AsyncFileWriter& writer;
+    int stream;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+// --- Origen de fotogramas de la aplicación (cámara, video, sintético...) ---
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    virtual bool isOpened() const = 0;
+    // Bloquea hasta el siguiente fotograma; false al terminar o si falla.
+    virtual bool read(cv::Mat& frame) = 0;
+    // Tamaño anunciado antes del primer fotograma (vacío si no se conoce).
+    virtual cv::Size frameSize() const { return cv::Size(); }
+
+    // Variante para el camino de visión: la fuente puede entregar el fotograma ya
+    // reducido si así le sale más barato; scale es tamaño entregado / tamaño real.
+    virtual bool readForVision(cv::Mat& frame, double& scale) {
+        scale = 1.0;
+        if (!read(frame)) return false;
+        lastVisionFrame = frame;
+        return true;
+    }
+    // Resolución completa del último fotograma de readForVision (fondo, grabación).
+    virtual bool fullFrame(cv::Mat& frame) {
+        frame = lastVisionFrame;
+        return !frame.empty();
+    }
+
+protected:
+    cv::Mat lastVisionFrame;
+};
+
+class CameraFrameSource final : public FrameSource {
+public:
+    explicit CameraFrameSource(int index) { cap.open(index); }
+    ~CameraFrameSource() override {
+        if (cap.isOpened()) cap.release();
+    }
+
+    bool isOpened() const override { return cap.isOpened(); }
+
+    bool read(cv::Mat& frame) override {
+        cap >> frame;
+        return !frame.empty();
+    }
+
+    cv::Size frameSize() const override {
+        return cv::Size((int)cap.get(cv::CAP_PROP_FRAME_WIDTH), (int)cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+    }
+
+private:
+    cv::VideoCapture cap;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <PerfStats.h>
+
+struct GLFWwindow;
+
+// --- Hilo de subidas a la GPU con un contexto compartido ---
+// Crea una ventana oculta cuyo contexto comparte objetos con el de la ventana
+// principal y ejecuta ahí los trabajos encolados (glBufferData, texturas). Cada
+// trabajo termina con un fence; el hilo de render consulta poll() sin bloquear y,
+// cuando devuelve true, los buffers y texturas ya están completos en la GPU.
+//
+// Los VAO no se comparten entre contextos: el trabajo crea el VBO y el hilo de
+// render arma el VAO al recibirlo (ver attachVertexArray).
+class GpuUploader {
+public:
+    using Ticket = uint64_t;
+
+    struct Stats {
+        long long jobs = 0;
+        long long bytes = 0;
+    };
+
+    GpuUploader() = default;
+    ~GpuUploader() { stop(); }
+
+    GpuUploader(const GpuUploader&) = delete;
+    GpuUploader& operator=(const GpuUploader&) = delete;
+
+    // Desde el hilo principal (GLFW solo crea ventanas ahí), con shareWith ya creada.
+    // false si el driver no permite el contexto compartido: las subidas siguen en el
+    // hilo de render.
+    bool start(GLFWwindow* shareWith);
+    // Ejecuta lo pendiente, para el hilo y destruye el contexto. Hilo principal.
+    void stop();
+    bool running() const { return worker.joinable(); }
+
+    // Encola un trabajo que corre con el contexto de subida activo. bytes es solo
+    // para las estadísticas.
+    Ticket submit(std::function<void()> job, size_t bytes = 0);
+    // true cuando el trabajo terminó y la GPU lo completó. Hilo de render; no bloquea.
+    bool poll(Ticket ticket);
+    // Espera a que se hayan ejecutado todos los trabajos encolados (para liberar al cerrar).
+    void drain();
+
+    Stats stats() const;
+    void printReport() const;
+
+private:
+    struct Job {
+        Ticket ticket = 0;
+        std::function<void()> work;
+        size_t bytes = 0;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    GLFWwindow* context = nullptr;
+    std::thread worker;
+
+    mutable std::mutex mutex;
+    std::condition_variable jobQueued, jobDone;
+    std::deque<Job> jobs;
+    struct Completion {
+        GLsync fence = nullptr;
+        std::chrono::steady_clock::time_point queued;
+    };
+    std::unordered_map<Ticket, Completion> completed; // trabajos ejecutados, pendientes de poll()
+    Ticket nextTicket = 1;
+    bool stopping = false;
+    bool busy = false;
+
+    Stats counters;
+    TimingStats jobTimes;   // ejecución en el hilo de subida
+    TimingStats readyTimes; // desde submit hasta que poll lo ve completo
+
+    void run();
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include <ResourceTracker.h>
+
+// --- Umbrales del detector de puño cerrado ---
+struct HandGestureParams {
+    cv::Scalar skinLow = cv::Scalar(0, 48, 80);    // rango de piel en HSV
+    cv::Scalar skinHigh = cv::Scalar(20, 255, 255);
+    int kernelSize = 7;                            // elemento estructurante de la apertura/cierre
+    double minArea = 8000;                         // umbral de área para evitar ruido
+    float minDefectDepth = 20;                     // profundidad (px) de un defecto "profundo"
+    int maxDeepDefects = 1;                        // un puño tiene como mucho un defecto profundo
+};
+
+// Detecta un puño cerrado: segmenta piel en HSV, toma el contorno más grande y
+// cuenta los defectos de convexidad profundos (los huecos entre dedos abiertos).
+// Los temporales se conservan entre llamadas para no reservar memoria por fotograma.
+class HandGestureDetector {
+public:
+    explicit HandGestureDetector(const HandGestureParams& params = HandGestureParams()) : p(params) {
+        kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(p.kernelSize, p.kernelSize));
+    }
+
+    const HandGestureParams& params() const { return p; }
+
+    bool detect(const cv::Mat& inputFrame) {
+        cv::cvtColor(inputFrame, hsvFrame, cv::COLOR_BGR2HSV);
+        cv::inRange(hsvFrame, p.skinLow, p.skinHigh, skinMask);
+        temporaries.set(hsvFrame.total() * hsvFrame.elemSize() + skinMask.total() * skinMask.elemSize());
+
+        cv::morphologyEx(skinMask, skinMask, cv::MORPH_OPEN, kernel);
+        cv::morphologyEx(skinMask, skinMask, cv::MORPH_CLOSE, kernel);
+
+        contours.clear();
+        cv::findContours(skinMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+        double maxArea = 0;
+        int maxAreaIdx = -1;
+        for (size_t i = 0; i < contours.size(); i++) {
+            double area = cv::contourArea(contours[i]);
+            if (area > maxArea) {
+                maxArea = area;
+                maxAreaIdx = i;
+            }
+        }
+
+        if (maxAreaIdx != -1 && maxArea > p.minArea) {
+            cv::convexHull(contours[maxAreaIdx], hullIndices, false); // 'false' para obtener índices
+
+            if (hullIndices.size() > 3) {
+                cv::convexityDefects(contours[maxAreaIdx], hullIndices, defects);
+
+                int deepDefectCount = 0;
+                for (const cv::Vec4i &v : defects) {
+                    float depth = v[3] / 256.0;
+                    if (depth > p.minDefectDepth) {
+                        deepDefectCount++;
+                    }
+                }
+
+                if (deepDefectCount <= p.maxDeepDefects) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    HandGestureParams p;
+    cv::Mat kernel, hsvFrame, skinMask;
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<int> hullIndices;
+    std::vector<cv::Vec4i> defects;
+    TrackedAllocation temporaries{ResourceCategory::VisionTemporaries};
+};
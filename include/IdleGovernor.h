@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+// --- Modo reposo para kioscos desatendidos ---
+// El hilo de render informa si cada fotograma cambió algo en pantalla (el resultado
+// de ARRenderer::execute con seguimiento de daño). Tras idleAfterSeconds sin cambios
+// se entra en reposo: el hilo que captura espera antes de cada lectura hasta bajar a
+// idleFps, así que la detección también trabaja menos. El primer fotograma con
+// cambios (movimiento en la imagen, un marcador, la ventana) vuelve al ritmo normal.
+//
+// Métricas de consumo: tiempo y uso de CPU del proceso en cada estado y, si el
+// kernel la expone sin privilegios, la energía del paquete (RAPL).
+class IdleGovernor {
+public:
+    struct Options {
+        double idleAfterSeconds = 0.0; // 0 desactiva el reposo
+        double idleFps = 4.0;
+    };
+
+    IdleGovernor() : IdleGovernor(Options()) {}
+    explicit IdleGovernor(const Options& options) : options(options) {}
+
+    bool enabled() const { return options.idleAfterSeconds > 0.0; }
+    bool idle() const { return isIdle.load(std::memory_order_relaxed); }
+
+    // Empieza a medir; se llama antes del bucle principal.
+    void start() {
+        const auto now = std::chrono::steady_clock::now();
+        lastDamage = now;
+        stateSince = now;
+        stateCpuSince = processCpuSeconds();
+        energyStartUj = readEnergyUj();
+        started = true;
+    }
+
+    // Hilo de render, una vez por fotograma procesado.
+    void frameRendered(bool damaged) {
+        if (!started) return;
+        const auto now = std::chrono::steady_clock::now();
+        damaged ? framesDrawn++ : framesSkipped++;
+        if (damaged) {
+            lastDamage = now;
+            if (idle()) {
+                closeState(now);
+                wakeups++;
+                setIdle(false);
+            }
+        } else if (enabled() && !idle() &&
+                   std::chrono::duration<double>(now - lastDamage).count() >= options.idleAfterSeconds) {
+            closeState(now);
+            setIdle(true);
+        }
+    }
+
+    // Hilo de captura, antes de leer cada fotograma. En reposo espera al siguiente
+    // turno de idleFps, o menos si el render sale del reposo entretanto.
+    void throttleCapture() {
+        const auto now = std::chrono::steady_clock::now();
+        if (!idle()) {
+            lastCapture = now;
+            return;
+        }
+        const auto next = lastCapture + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                            std::chrono::duration<double>(1.0 / options.idleFps));
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_until(lock, next, [this] { return !idle(); });
+        }
+        lastCapture = std::chrono::steady_clock::now();
+        idleCaptures++;
+    }
+
+    void printReport() {
+        if (!started) return;
+        closeState(std::chrono::steady_clock::now());
+        const double wall = activeSeconds + idleSeconds;
+        const double cpu = activeCpuSeconds + idleCpuSeconds;
+        std::cout << "Energía: " << framesDrawn << " fotogramas dibujados, " << framesSkipped
+                  << " sin cambios; CPU del proceso " << 100.0 * cpu / std::max(1e-9, wall) << "% de un núcleo"
+                  << std::endl;
+        if (enabled()) {
+            std::cout << "Reposo: " << idleSeconds << " s de " << wall << " s (" << wakeups << " despertares, "
+                      << idleCaptures << " capturas en reposo); CPU activo "
+                      << 100.0 * activeCpuSeconds / std::max(1e-9, activeSeconds) << "%, en reposo "
+                      << 100.0 * idleCpuSeconds / std::max(1e-9, idleSeconds) << "%" << std::endl;
+        }
+        const long long energyEndUj = readEnergyUj();
+        if (energyStartUj >= 0 && energyEndUj >= energyStartUj && wall > 0.0) {
+            const double joules = (energyEndUj - energyStartUj) / 1e6;
+            std::cout << "Paquete (RAPL): " << joules << " J, " << joules / wall << " W de media" << std::endl;
+        }
+    }
+
+private:
+    Options options;
+    std::atomic<bool> isIdle{false};
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool started = false;
+
+    // Solo el hilo de render.
+    std::chrono::steady_clock::time_point lastDamage, stateSince;
+    double stateCpuSince = 0.0;
+    double activeSeconds = 0.0, idleSeconds = 0.0;
+    double activeCpuSeconds = 0.0, idleCpuSeconds = 0.0;
+    long long framesDrawn = 0, framesSkipped = 0, wakeups = 0;
+    long long energyStartUj = -1;
+
+    // Solo el hilo de captura.
+    std::chrono::steady_clock::time_point lastCapture;
+    long long idleCaptures = 0;
+
+    void setIdle(bool value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isIdle.store(value, std::memory_order_relaxed);
+        }
+        wake.notify_all();
+        std::cout << (value ? "Sin cambios: modo reposo" : "Movimiento: fin del reposo") << std::endl;
+    }
+
+    // Suma el tramo desde stateSince al estado actual.
+    void closeState(std::chrono::steady_clock::time_point now) {
+        const double seconds = std::chrono::duration<double>(now - stateSince).count();
+        const double cpuNow = processCpuSeconds();
+        (idle() ? idleSeconds : activeSeconds) += seconds;
+        (idle() ? idleCpuSeconds : activeCpuSeconds) += cpuNow - stateCpuSince;
+        stateSince = now;
+        stateCpuSince = cpuNow;
+    }
+
+    static double processCpuSeconds() {
+        timespec ts{};
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    // Contador de energía del paquete 0 en microjulios, -1 si no se puede leer
+    // (otra arquitectura o sin permisos, que es lo habitual).
+    static long long readEnergyUj() {
+        std::ifstream file("/sys/class/powercap/intel-rapl:0/energy_uj");
+        long long value = -1;
+        if (!(file >> value)) return -1;
+        return value;
+    }
+};
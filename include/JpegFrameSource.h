@@ -0,0 +1,174 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <FrameSource.h>
+
+// --- Fuente de fotogramas JPEG con decodificación reducida en el dominio DCT ---
+// Acepta secuencias de imágenes (directorio terminado en '/' o patrón con '*'),
+// flujos MJPEG crudos (.mjpeg/.mjpg: JPEGs concatenados) y contenedores cuyo códec
+// es MJPG (se leen los paquetes sin decodificar). Cada fotograma se guarda
+// comprimido; readForVision() lo decodifica a 1/2, 1/4 u 1/8 con IMREAD_REDUCED_*,
+// que libjpeg resuelve descartando coeficientes DCT en lugar de reescalar, y la
+// resolución completa solo se decodifica si alguien la pide (fondo o grabación).
+class JpegFrameSource final : public FrameSource {
+public:
+    // reduction: 1, 2, 4 u 8. Devuelve nullptr si path no es una entrada JPEG.
+    static std::unique_ptr<JpegFrameSource> open(const std::string& path, int reduction) {
+        std::unique_ptr<JpegFrameSource> source(new JpegFrameSource(reduction));
+        if (path.find('*') != std::string::npos || path.back() == '/') {
+            cv::glob(path.back() == '/' ? path + "*.jp*g" : path, source->files);
+            std::sort(source->files.begin(), source->files.end());
+            source->mode = Mode::ImageSequence;
+        } else if (hasExtension(path, ".mjpeg") || hasExtension(path, ".mjpg")) {
+            source->stream.open(path, std::ios::binary);
+            source->mode = Mode::RawStream;
+        } else {
+            // Contenedor: solo sirve si el códec es MJPG; con CAP_PROP_FORMAT = -1
+            // el backend de FFmpeg entrega el paquete comprimido tal cual.
+            cv::VideoCapture& container = source->container;
+            container.open(path, cv::CAP_FFMPEG);
+            const int fourcc = (int)container.get(cv::CAP_PROP_FOURCC);
+            if (!container.isOpened() || fourcc != cv::VideoWriter::fourcc('M', 'J', 'P', 'G')) return nullptr;
+            source->size = cv::Size((int)container.get(cv::CAP_PROP_FRAME_WIDTH), (int)container.get(cv::CAP_PROP_FRAME_HEIGHT));
+            container.set(cv::CAP_PROP_FORMAT, -1);
+            source->mode = Mode::Container;
+        }
+        if (!source->isOpened()) return nullptr;
+        return source;
+    }
+
+    bool isOpened() const override {
+        switch (mode) {
+            case Mode::ImageSequence: return !files.empty();
+            case Mode::RawStream: return stream.is_open();
+            case Mode::Container: return container.isOpened();
+        }
+        return false;
+    }
+
+    bool read(cv::Mat& frame) override {
+        return next() && decodeFull(frame);
+    }
+
+    // Avanza un fotograma sin decodificarlo (empezar a mitad de una grabación).
+    bool skip() {
+        return next();
+    }
+
+    bool readForVision(cv::Mat& frame, double& scale) override {
+        if (!next()) return false;
+        scale = 1.0 / reduction;
+        frame = cv::imdecode(compressed, reducedFlag(reduction));
+        return !frame.empty();
+    }
+
+    bool fullFrame(cv::Mat& frame) override {
+        return decodeFull(frame);
+    }
+
+    cv::Size frameSize() const override { return size; }
+
+private:
+    enum class Mode { ImageSequence, RawStream, Container };
+
+    Mode mode = Mode::ImageSequence;
+    int reduction;
+    std::vector<std::string> files;
+    size_t nextFile = 0;
+    std::ifstream stream;
+    cv::VideoCapture container;
+
+    std::vector<uchar> compressed; // fotograma actual sin decodificar
+    cv::Mat full;                  // caché de la decodificación completa del actual
+    bool fullValid = false;
+    cv::Size size;
+
+    explicit JpegFrameSource(int reduction) : reduction(reduction == 2 || reduction == 4 || reduction == 8 ? reduction : 1) {}
+
+    static bool hasExtension(const std::string& path, const std::string& extension) {
+        if (path.size() < extension.size()) return false;
+        std::string tail = path.substr(path.size() - extension.size());
+        std::transform(tail.begin(), tail.end(), tail.begin(), ::tolower);
+        return tail == extension;
+    }
+
+    static int reducedFlag(int reduction) {
+        switch (reduction) {
+            case 2: return cv::IMREAD_REDUCED_COLOR_2;
+            case 4: return cv::IMREAD_REDUCED_COLOR_4;
+            case 8: return cv::IMREAD_REDUCED_COLOR_8;
+            default: return cv::IMREAD_COLOR;
+        }
+    }
+
+    bool decodeFull(cv::Mat& frame) {
+        if (!fullValid) {
+            full = cv::imdecode(compressed, cv::IMREAD_COLOR);
+            fullValid = !full.empty();
+            if (fullValid && size.empty()) size = full.size();
+        }
+        frame = full;
+        return fullValid;
+    }
+
+    // Avanza al siguiente fotograma comprimido.
+    bool next() {
+        fullValid = false;
+        switch (mode) {
+            case Mode::ImageSequence: return nextFileFrame();
+            case Mode::RawStream: return nextStreamFrame();
+            case Mode::Container: return nextPacket();
+        }
+        return false;
+    }
+
+    bool nextFileFrame() {
+        while (nextFile < files.size()) {
+            std::ifstream file(files[nextFile++], std::ios::binary | std::ios::ate);
+            if (!file) continue;
+            compressed.resize((size_t)file.tellg());
+            file.seekg(0);
+            if (file.read(reinterpret_cast<char*>(compressed.data()), compressed.size())) return true;
+        }
+        return false;
+    }
+
+    // Un JPEG va de SOI (FF D8) a EOI (FF D9). Dentro de los datos entrópicos un
+    // 0xFF siempre va seguido de 0x00 o de un marcador RSTn, así que basta con
+    // buscar el EOI.
+    bool nextStreamFrame() {
+        compressed.clear();
+        int previous = -1, byte;
+        bool inFrame = false;
+        while ((byte = stream.get()) != EOF) {
+            if (!inFrame) {
+                if (previous == 0xFF && byte == 0xD8) {
+                    inFrame = true;
+                    compressed.push_back(0xFF);
+                    compressed.push_back(0xD8);
+                }
+            } else {
+                compressed.push_back((uchar)byte);
+                if (previous == 0xFF && byte == 0xD9) return true;
+            }
+            previous = byte;
+        }
+        return false;
+    }
+
+    bool nextPacket() {
+        cv::Mat packet;
+        if (!container.read(packet) || packet.empty()) return false;
+        const uchar* data = packet.ptr<uchar>();
+        compressed.assign(data, data + packet.total() * packet.elemSize());
+        return true;
+    }
+};
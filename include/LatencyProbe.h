@@ -0,0 +1,159 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <FrameSource.h>
+#include <PerfStats.h>
+
+// --- Medición de latencia de extremo a extremo (captura -> pantalla) ---
+// Cada fotograma lleva en la franja superior una marca de tiempo legible por
+// máquina: dos celdas de sincronía (blanca, negra) y 32 bits con los microsegundos
+// del reloj monótono. Tras componer, se lee una fila del framebuffer, se decodifica
+// la marca y, al volver del intercambio de buffers, se registra la latencia.
+class TimestampCode {
+public:
+    static constexpr int bits = 32;
+    static constexpr int cells = bits + 2;
+
+    static uint32_t nowMicros() {
+        using namespace std::chrono;
+        return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    static int cellSize(cv::Size frameSize) { return std::max(8, frameSize.width / 80); }
+    static int margin(cv::Size frameSize) { return cellSize(frameSize); }
+
+    static void stamp(cv::Mat& frame, uint32_t micros) {
+        const int cell = cellSize(frame.size());
+        const int m = margin(frame.size());
+        for (int i = 0; i < cells; ++i) {
+            bool white;
+            if (i == 0) white = true;
+            else if (i == 1) white = false;
+            else white = (micros >> (bits - 1 - (i - 2))) & 1u;
+            cv::rectangle(frame, cv::Rect(m + i * cell, m, cell, cell),
+                          white ? cv::Scalar(255, 255, 255) : cv::Scalar(0, 0, 0), cv::FILLED);
+        }
+    }
+
+    // Lee del framebuffer activo la fila que atraviesa el centro de las celdas.
+    // El fondo cubre toda la ventana, así que basta con escalar las coordenadas.
+    static bool decodeFromFramebuffer(cv::Size framebufferSize, cv::Size frameSize, uint32_t& micros,
+                                      std::vector<unsigned char>& row) {
+        const int cell = cellSize(frameSize);
+        const int m = margin(frameSize);
+        const double sx = (double)framebufferSize.width / frameSize.width;
+        const double sy = (double)framebufferSize.height / frameSize.height;
+        const int windowY = framebufferSize.height - 1 - (int)((m + cell / 2.0) * sy);
+        if (windowY < 0) return false;
+
+        row.resize((size_t)framebufferSize.width * 3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, windowY, framebufferSize.width, 1, GL_RGB, GL_UNSIGNED_BYTE, row.data());
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+        micros = 0;
+        for (int i = 0; i < cells; ++i) {
+            const int x = std::min(framebufferSize.width - 1, (int)((m + i * cell + cell / 2.0) * sx));
+            const unsigned char* px = &row[(size_t)x * 3];
+            const bool white = (px[0] + px[1] + px[2]) > 3 * 128;
+            if (i == 0 && !white) return false;
+            if (i == 1 && white) return false;
+            if (i >= 2) micros = (micros << 1) | (white ? 1u : 0u);
+        }
+        return true;
+    }
+};
+
+// Fuente sintética a ritmo de cámara: fondo gris, un marcador ArUco en el centro
+// (para ejercitar detección y render) y la marca de tiempo en la franja superior.
+class TimestampFrameSource final : public FrameSource {
+public:
+    TimestampFrameSource(cv::Size size, const cv::aruco::Dictionary& dictionary, double fps = 30.0)
+        : size(size), period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                          std::chrono::duration<double>(1.0 / fps))) {
+        base = cv::Mat(size, CV_8UC3, cv::Scalar(128, 128, 128));
+        const int side = std::min(size.width, size.height) / 3;
+        cv::Mat marker, markerBGR;
+        cv::aruco::generateImageMarker(dictionary, 0, side, marker);
+        cv::cvtColor(marker, markerBGR, cv::COLOR_GRAY2BGR);
+        // Borde blanco alrededor del marcador para que el detector lo encuentre.
+        const cv::Rect border((size.width - side) / 2 - side / 8, (size.height - side) / 2 - side / 8,
+                              side + side / 4, side + side / 4);
+        cv::rectangle(base, border, cv::Scalar(255, 255, 255), cv::FILLED);
+        markerBGR.copyTo(base(cv::Rect((size.width - side) / 2, (size.height - side) / 2, side, side)));
+        nextFrame = std::chrono::steady_clock::now();
+    }
+
+    bool isOpened() const override { return true; }
+
+    bool read(cv::Mat& frame) override {
+        std::this_thread::sleep_until(nextFrame);
+        nextFrame = std::max(nextFrame + period, std::chrono::steady_clock::now());
+        base.copyTo(frame);
+        TimestampCode::stamp(frame, TimestampCode::nowMicros());
+        return true;
+    }
+
+private:
+    cv::Size size;
+    std::chrono::steady_clock::duration period;
+    std::chrono::steady_clock::time_point nextFrame;
+    cv::Mat base;
+};
+
+// Acumula las latencias de una configuración y las publica como histograma.
+class LatencyProbe {
+public:
+    // Después de componer y antes del intercambio de buffers.
+    void captureBeforeSwap(cv::Size framebufferSize, cv::Size frameSize) {
+        pending = TimestampCode::decodeFromFramebuffer(framebufferSize, frameSize, pendingMicros, row);
+        if (!pending) decodeFailures++;
+    }
+
+    // Justo después de que el intercambio de buffers vuelva.
+    void recordAfterSwap() {
+        if (!pending) return;
+        const uint32_t now = TimestampCode::nowMicros();
+        latencies.add((uint32_t)(now - pendingMicros) / 1000.0); // la resta sin signo tolera el desborde
+        pending = false;
+    }
+
+    void print(const std::string& name) const {
+        std::cout << "\n--- LATENCIA (" << name << ") ---" << std::endl;
+        latencies.print("Captura a pantalla");
+        if (decodeFailures) std::cout << "Marcas no decodificadas: " << decodeFailures << std::endl;
+        if (latencies.count() == 0) return;
+
+        const double binMs = 5.0;
+        const int binCount = 30;
+        std::vector<int> bins(binCount + 1, 0);
+        for (size_t i = 0; i < latencies.size(); ++i) {
+            const int bin = std::min(binCount, (int)(latencies.sample(i) / binMs));
+            bins[bin]++;
+        }
+        const int peak = *std::max_element(bins.begin(), bins.end());
+        for (int b = 0; b <= binCount; ++b) {
+            if (bins[b] == 0) continue;
+            const int bar = std::max(1, 50 * bins[b] / peak);
+            std::cout << (b == binCount ? ">=" : "  ") << (int)(b * binMs) << " ms\t" << bins[b] << "\t"
+                      << std::string(bar, '#') << std::endl;
+        }
+    }
+
+private:
+    TimingStats latencies;
+    std::vector<unsigned char> row;
+    uint32_t pendingMicros = 0;
+    bool pending = false;
+    long long decodeFailures = 0;
+};
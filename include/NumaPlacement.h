@@ -0,0 +1,246 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Topología NUMA leída de sysfs ---
+// Sin /sys/devices/system/node (kernel sin NUMA) hay un único nodo con todas las CPU.
+// Los nodos sin CPU (solo memoria) no se listan: no se les pueden atar hilos.
+class NumaTopology {
+public:
+    struct Node {
+        int id = 0;
+        std::vector<int> cpus;
+    };
+
+    static NumaTopology detect() {
+        NumaTopology topology;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 || !std::isdigit((unsigned char)name[4]))
+                continue;
+            std::ifstream file(entry.path() / "cpulist");
+            std::string list;
+            std::getline(file, list);
+            Node node;
+            node.id = std::stoi(name.substr(4));
+            node.cpus = parseCpuList(list);
+            if (!node.cpus.empty()) topology.nodeList.push_back(node);
+        }
+        std::sort(topology.nodeList.begin(), topology.nodeList.end(),
+                  [](const Node& a, const Node& b) { return a.id < b.id; });
+        if (topology.nodeList.empty()) {
+            Node node;
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+                node.cpus.push_back((int)cpu);
+            topology.nodeList.push_back(node);
+        }
+        return topology;
+    }
+
+    const std::vector<Node>& nodes() const { return nodeList; }
+
+    // -1 si la CPU no aparece en ningún nodo.
+    int nodeOfCpu(int cpu) const {
+        for (const Node& node : nodeList)
+            if (std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) return node.id;
+        return -1;
+    }
+
+    const Node* find(int id) const {
+        for (const Node& node : nodeList)
+            if (node.id == id) return &node;
+        return nullptr;
+    }
+
+    // Nodo del controlador al que está conectada /dev/videoN (se sube por sysfs hasta
+    // el primer dispositivo PCI con numa_node); -1 si el kernel no lo sabe.
+    static int videoDeviceNode(int index) {
+        std::error_code error;
+        std::filesystem::path dir = std::filesystem::canonical(
+            "/sys/class/video4linux/video" + std::to_string(index) + "/device", error);
+        for (; !error && dir.has_relative_path(); dir = dir.parent_path()) {
+            std::ifstream file(dir / "numa_node");
+            int node = -1;
+            if (file >> node) return node;
+        }
+        return -1;
+    }
+
+    // "0-7,16-23" -> {0, ..., 7, 16, ..., 23}
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream stream(list);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            int first = 0, last = 0;
+            const int fields = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (fields < 1) continue;
+            if (fields == 1) last = first;
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    static std::string formatCpuList(const std::vector<int>& cpus) {
+        std::string text;
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+            if (!text.empty()) text += ",";
+            text += std::to_string(cpus[i]);
+            if (j > i) text += "-" + std::to_string(cpus[j]);
+            i = j + 1;
+        }
+        return text;
+    }
+
+private:
+    std::vector<Node> nodeList;
+};
+
+// --- Colocación de un pipeline de cámara en un nodo NUMA ---
+// bindCurrentThread() ata el hilo a las CPU del nodo y le da una política de memoria
+// preferente en ese nodo. Los hilos creados después heredan ambas cosas, así que basta
+// con llamarlo en el hilo que arranca el pipeline antes de que cree los suyos
+// (decodificación, escritura a disco, carga de modelos). Lo que esos hilos reserven y
+// toquen primero (fotogramas, espacios de trabajo de OpenCV) queda en el nodo.
+//
+// Con node < 0 no se toca nada y el kernel coloca como siempre. sampleResidency()
+// consulta con move_pages, sin mover nada, en qué nodo están de verdad las páginas
+// de un bloque: así las métricas muestran la colocación también sin --numa-node.
+//
+// <numaif.h> viene con libnuma, que no es dependencia: llamadas al sistema directas
+// con las constantes de la ABI del kernel.
+class NumaPlacement {
+public:
+    static constexpr int noNode = -1;
+    static constexpr int cameraNode = -2; // el del controlador de la cámara, si se conoce
+
+    explicit NumaPlacement(int node = noNode, int cameraIndex = 0) : topology(NumaTopology::detect()) {
+        if (node == cameraNode) {
+            node = NumaTopology::videoDeviceNode(cameraIndex);
+            if (node < 0)
+                std::cout << "NUMA: no se conoce el nodo de la cámara " << cameraIndex << ", sin colocación"
+                          << std::endl;
+        }
+        if (node < 0) return;
+        const NumaTopology::Node* found = topology.find(node);
+        if (!found) {
+            std::cerr << "Advertencia: El nodo NUMA " << node << " no existe o no tiene CPU, sin colocación"
+                      << std::endl;
+            return;
+        }
+        nodeId = node;
+        cpus = found->cpus;
+    }
+
+    NumaPlacement(const NumaPlacement&) = delete;
+    NumaPlacement& operator=(const NumaPlacement&) = delete;
+
+    bool enabled() const { return nodeId >= 0; }
+    int node() const { return nodeId; }
+    const NumaTopology& getTopology() const { return topology; }
+
+    bool bindCurrentThread(const std::string& label) {
+        if (!enabled()) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus)
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        const bool affinity = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+
+        std::vector<unsigned long> mask = nodeMask();
+        const bool policy = syscall(SYS_set_mempolicy, mpolPreferred, mask.data(), maskBits + 1) == 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        boundThreads.push_back(label + (affinity && policy ? "" : " (falló)"));
+        return affinity && policy;
+    }
+
+    // Muestrea hasta maxSamples páginas repartidas por el bloque y las acumula bajo label.
+    void sampleResidency(const std::string& label, const void* data, size_t bytes, int maxSamples = 64) {
+        const std::vector<int> nodes = pageNodes(data, bytes, maxSamples);
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<int, long long>& pagesByNode = residency[label];
+        for (int node : nodes) pagesByNode[node >= 0 ? node : -1]++; // -1: sin tocar todavía
+    }
+
+    // Nodo de hasta maxSamples páginas repartidas por el bloque (negativo: sin residir).
+    static std::vector<int> pageNodes(const void* data, size_t bytes, int maxSamples = 64) {
+        if (!data || bytes == 0) return {};
+        const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+        const uintptr_t first = (uintptr_t)data & ~(page - 1);
+        const size_t pages = ((uintptr_t)data + bytes - first + page - 1) / page;
+        const size_t samples = std::min(pages, (size_t)std::max(1, maxSamples));
+        std::vector<void*> addresses(samples);
+        std::vector<int> status(samples, -1);
+        for (size_t i = 0; i < samples; ++i) addresses[i] = (void*)(first + (i * pages / samples) * page);
+        if (syscall(SYS_move_pages, 0, samples, addresses.data(), nullptr, status.data(), 0) != 0) return {};
+        return status;
+    }
+
+    void printReport() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const size_t nodeCount = topology.nodes().size();
+        if (!enabled() && nodeCount < 2 && residency.empty()) return;
+        if (enabled()) {
+            std::cout << "NUMA: pipeline en el nodo " << nodeId << " (CPUs " << NumaTopology::formatCpuList(cpus)
+                      << ", " << nodeCount << " nodos); hilos atados:";
+            for (const std::string& label : boundThreads) std::cout << " " << label;
+            std::cout << std::endl;
+        } else {
+            std::cout << "NUMA: sin colocación (" << nodeCount << " nodos)" << std::endl;
+        }
+        for (const auto& [label, pagesByNode] : residency) {
+            long long total = 0, local = 0;
+            std::cout << "  " << label << ":";
+            for (const auto& [node, pages] : pagesByNode) {
+                total += pages;
+                if (node == nodeId) local += pages;
+                if (node < 0)
+                    std::cout << " " << pages << " páginas sin residir";
+                else
+                    std::cout << " nodo " << node << " " << pages << " páginas";
+            }
+            if (enabled()) std::cout << " (" << 100.0 * local / std::max(1LL, total) << "% locales)";
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    static constexpr int mpolPreferred = 1;
+    static constexpr unsigned long maskBits = 1024; // MAX_NUMNODES de los kernels de distribución
+
+    NumaTopology topology;
+    int nodeId = noNode;
+    std::vector<int> cpus;
+
+    mutable std::mutex mutex;
+    std::vector<std::string> boundThreads;
+    std::map<std::string, std::map<int, long long>> residency; // páginas muestreadas por nodo
+
+    std::vector<unsigned long> nodeMask() const {
+        const size_t bitsPerWord = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> mask(maskBits / bitsPerWord, 0);
+        mask[(size_t)nodeId / bitsPerWord] |= 1UL << ((size_t)nodeId % bitsPerWord);
+        return mask;
+    }
+};
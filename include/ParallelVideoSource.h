@@ -0,0 +1,177 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <climits>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <FrameSource.h>
+#include <ResourceTracker.h>
+
+// --- Decodificación de video por segmentos en paralelo (procesamiento fuera de línea) ---
+// El archivo se parte en segmentos de segmentFrames fotogramas y cada hilo decodifica
+// segmentos completos con su propio cv::VideoCapture. El salto a cada segmento lo
+// resuelve el backend (FFmpeg busca el keyframe anterior y decodifica hasta el
+// fotograma pedido), así que los segmentos deben abarcar varios GOPs para que ese
+// precalentamiento se amortice. read() entrega los fotogramas en orden a través de
+// un búfer de reordenamiento: como mucho hay maxSegmentsInFlight segmentos por
+// delante del que se está consumiendo, y nunca más de los que caben en
+// maxBufferedBytes (16 hilos x 48 fotogramas de 1080p serían ~5 GB sin ese tope).
+//
+// CAP_PROP_FRAME_COUNT es aproximado en algunos contenedores, así que solo sirve de
+// estimación: se siguen reclamando segmentos de segmentFrames hasta que uno llega
+// al final del archivo, sin un último segmento de longitud ilimitada.
+class ParallelVideoFrameSource final : public FrameSource {
+public:
+    static constexpr size_t defaultBufferedBytes = 1024ull * 1024 * 1024;
+
+    explicit ParallelVideoFrameSource(const std::string& path, int threads = 0, int segmentFrames = 48,
+                                      int maxSegmentsInFlight = 0, size_t maxBufferedBytes = defaultBufferedBytes)
+        : path(path), segmentFrames(std::max(1, segmentFrames)) {
+        cv::VideoCapture probe(path);
+        if (!probe.isOpened()) {
+            std::cerr << "Error: No se pudo abrir el video " << path << std::endl;
+            return;
+        }
+        size = cv::Size((int)probe.get(cv::CAP_PROP_FRAME_WIDTH), (int)probe.get(cv::CAP_PROP_FRAME_HEIGHT));
+        const int frameCount = std::max(1, (int)probe.get(cv::CAP_PROP_FRAME_COUNT));
+        const int estimatedSegments = (frameCount + this->segmentFrames - 1) / this->segmentFrames;
+
+        // Fotogramas BGR de 8 bits, lo que entrega cv::VideoCapture.
+        const size_t segmentBytes = std::max<size_t>(1, (size_t)size.area() * 3) * (size_t)this->segmentFrames;
+        const int budgetSegments = (int)std::clamp<size_t>(maxBufferedBytes / segmentBytes, 1, INT_MAX);
+        if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        inFlight = std::min(maxSegmentsInFlight > 0 ? maxSegmentsInFlight : threads, budgetSegments);
+        // Más hilos que segmentos en vuelo solo esperarían.
+        threads = std::min({threads, inFlight, estimatedSegments + 1});
+        opened = true;
+
+        std::cout << "Video " << path << ": ~" << frameCount << " fotogramas, ~" << estimatedSegments
+                  << " segmentos de " << this->segmentFrames << ", " << threads << " hilos de decodificación, "
+                  << inFlight << " segmentos en vuelo (" << inFlight * segmentBytes / (1024 * 1024) << " MB)"
+                  << std::endl;
+        for (int i = 0; i < threads; ++i) workers.emplace_back([this] { decodeLoop(); });
+    }
+
+    ~ParallelVideoFrameSource() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        windowAdvanced.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        for (auto& entry : completed) trackedBytes.release(entry.second);
+        trackedBytes.release(current);
+    }
+
+    bool isOpened() const override { return opened; }
+
+    cv::Size frameSize() const override { return size; }
+
+    bool read(cv::Mat& frame) override {
+        if (!opened) return false;
+        while (consumerIndex >= current.frames.size()) {
+            if (current.endOfStream) return false;
+            trackedBytes.release(current);
+            std::unique_lock<std::mutex> lock(mutex);
+            segmentReady.wait(lock, [&] { return completed.count(consumerSegment) > 0; });
+            current = std::move(completed[consumerSegment]);
+            completed.erase(consumerSegment);
+            consumerSegment++;
+            consumerIndex = 0;
+            windowAdvanced.notify_all();
+        }
+        frame = std::move(current.frames[consumerIndex++]);
+        return true;
+    }
+
+private:
+    struct Segment {
+        std::vector<cv::Mat> frames;
+        bool endOfStream = false; // el archivo terminó dentro de este segmento
+        size_t bytes = 0;
+    };
+
+    // Bytes del búfer de reordenamiento, contados como fotogramas de CPU.
+    struct SegmentBytes {
+        void add(Segment& segment) {
+            for (const cv::Mat& frame : segment.frames) segment.bytes += frame.total() * frame.elemSize();
+            ResourceTracker::instance().allocate(ResourceCategory::FrameBuffers, segment.bytes);
+        }
+        void release(Segment& segment) {
+            ResourceTracker::instance().release(ResourceCategory::FrameBuffers, segment.bytes);
+            segment.bytes = 0;
+        }
+    };
+
+    std::string path;
+    cv::Size size;
+    int segmentFrames;
+    int inFlight = 1;
+    bool opened = false;
+
+    std::mutex mutex;
+    std::condition_variable segmentReady, windowAdvanced;
+    std::map<int, Segment> completed; // búfer de reordenamiento por índice de segmento
+    int nextSegmentToClaim = 0;
+    int endSegment = INT_MAX; // primer segmento que llegó al final del archivo
+    int consumerSegment = 0; // siguiente segmento que read() va a tomar
+    bool stopping = false;
+    std::vector<std::thread> workers;
+    SegmentBytes trackedBytes;
+
+    // Solo los usa el hilo que llama a read().
+    Segment current;
+    size_t consumerIndex = 0;
+
+    void decodeLoop() {
+        cv::VideoCapture cap;
+        // Un hilo de FFmpeg por captura: el paralelismo viene de los segmentos.
+        cap.open(path, cv::CAP_ANY, {cv::CAP_PROP_N_THREADS, 1});
+        if (!cap.isOpened()) cap.open(path);
+        int position = 0; // fotograma en el que está la captura
+
+        while (true) {
+            int segment;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                windowAdvanced.wait(lock, [&] {
+                    return stopping || nextSegmentToClaim > endSegment ||
+                           nextSegmentToClaim < consumerSegment + inFlight;
+                });
+                if (stopping || nextSegmentToClaim > endSegment) return;
+                segment = nextSegmentToClaim++;
+            }
+
+            const int start = segment * segmentFrames;
+            if (position != start) cap.set(cv::CAP_PROP_POS_FRAMES, start);
+
+            Segment decoded;
+            decoded.frames.reserve(segmentFrames);
+            while ((int)decoded.frames.size() < segmentFrames) {
+                cv::Mat frame;
+                if (!cap.read(frame)) {
+                    decoded.endOfStream = true;
+                    break;
+                }
+                decoded.frames.push_back(std::move(frame));
+            }
+            position = start + (int)decoded.frames.size();
+            trackedBytes.add(decoded);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            // Los segmentos posteriores al final ya no se reclaman; los ya reclamados
+            // terminan vacíos y read() no llega a ellos.
+            if (decoded.endOfStream) endSegment = std::min(endSegment, segment);
+            completed[segment] = std::move(decoded);
+            segmentReady.notify_all();
+            windowAdvanced.notify_all();
+        }
+    }
+};
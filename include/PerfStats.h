@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Milisegundos transcurridos desde start.
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// --- Distribución de tiempos (media, percentiles y máximo) ---
+// Guarda solo las últimas `capacity` muestras en un anillo, para que una ejecución
+// larga no crezca sin límite. count(), mean() y max() cubren todas las muestras
+// desde reset(); percentile() y sample(i) solo las size() retenidas.
+class TimingStats {
+public:
+    static constexpr size_t defaultCapacity = 8192;
+
+    explicit TimingStats(size_t capacity = defaultCapacity) : capacity(std::max<size_t>(1, capacity)) {}
+
+    void add(double ms) {
+        if (samples.size() < capacity) {
+            samples.push_back(ms);
+        } else {
+            samples[next] = ms;
+            next = (next + 1) % capacity;
+        }
+        total++;
+        sum += ms;
+        maxSample = total == 1 ? ms : std::max(maxSample, ms);
+        sortedValid = false;
+    }
+
+    void reset() {
+        samples.clear();
+        sorted.clear();
+        next = 0;
+        total = 0;
+        sum = 0.0;
+        maxSample = 0.0;
+        sortedValid = true;
+    }
+
+    // Muestras añadidas desde reset() (incluidas las que ya salieron del anillo).
+    size_t count() const { return total; }
+    // Muestras retenidas; sample(i) va de la más antigua (0) a la más reciente.
+    size_t size() const { return samples.size(); }
+    double sample(size_t i) const { return samples[(next + i) % samples.size()]; }
+    double mean() const { return total == 0 ? 0.0 : sum / total; }
+
+    double percentile(double p) const {
+        if (samples.empty()) return 0.0;
+        sortSamples();
+        const size_t index = std::min(sorted.size() - 1, (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5));
+        return sorted[index];
+    }
+
+    double max() const { return maxSample; }
+
+    void print(const std::string& name) const {
+        if (total == 0) return;
+        std::cout << name << ": " << count() << " muestras";
+        if (size() < count()) std::cout << " (percentiles de las últimas " << size() << ")";
+        std::cout << ", media " << mean() << " ms, p50 " << percentile(50) << " ms, p95 " << percentile(95)
+                  << " ms, p99 " << percentile(99) << " ms, máx " << max() << " ms" << std::endl;
+    }
+
+private:
+    size_t capacity;
+    std::vector<double> samples; // anillo; next es la posición de la más antigua cuando está lleno
+    size_t next = 0;
+    size_t total = 0;
+    double sum = 0.0;
+    double maxSample = 0.0;
+    mutable std::vector<double> sorted; // copia ordenada para los percentiles
+    mutable bool sortedValid = true;
+
+    void sortSamples() const {
+        if (sortedValid) return;
+        sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        sortedValid = true;
+    }
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// --- Lista de comandos de render grabada fuera del hilo de GL ---
+// Los hilos de trabajo calculan matrices y graban comandos POD (uniformes, dibujos
+// y geometría de overlay); el hilo de GLFW solo los ejecuta. Las ubicaciones de
+// uniformes se resuelven de antemano, así que grabar no llama a GL.
+enum class RenderOp : uint8_t {
+    UseProgram,
+    UniformMat4,
+    UniformVec3,
+    UniformInt,
+    BindTexture,
+    DrawArrays
+};
+
+struct RenderCommand {
+    RenderOp op;
+    int32_t location;  // ubicación del uniforme o unidad de textura
+    uint32_t object;   // programa, textura o VAO
+    uint32_t offset;   // primer float en uniformData o primer vértice
+    uint32_t count;
+};
+static_assert(std::is_trivially_copyable<RenderCommand>::value, "RenderCommand debe ser POD");
+
+class RenderCommandList {
+public:
+    // Cabecera del fotograma que el hilo de GL necesita para componer.
+    bool modelVisible = false;
+    int modelRect[4] = {0, 0, 0, 0}; // x, y, ancho, alto en píxeles del framebuffer
+    uint32_t modelGeneration = 0;    // modelo activo al grabar (ver ARRenderer::requestModelSwap)
+    bool animating = false;          // había una animación en curso al grabar
+    // Referencias a modelos del AssetManager usados por la lista; las devuelve el
+    // renderizador al ejecutarla (o al regrabarla si se descartó). reset() no las toca.
+    std::vector<uint32_t> assetRefs;
+    double buildMs = 0.0;
+
+    void reset() {
+        commands.clear();
+        uniformData.clear();
+        overlayVertices.clear();
+        modelVisible = false;
+        animating = false;
+        modelRect[0] = modelRect[1] = modelRect[2] = modelRect[3] = 0;
+        buildMs = 0.0;
+    }
+
+    void useProgram(GLuint program) {
+        commands.push_back({RenderOp::UseProgram, 0, program, 0, 0});
+    }
+
+    void uniformMat4(GLint location, const float* value) {
+        commands.push_back({RenderOp::UniformMat4, location, 0, appendFloats(value, 16), 1});
+    }
+
+    void uniformVec3(GLint location, const float* value) {
+        commands.push_back({RenderOp::UniformVec3, location, 0, appendFloats(value, 3), 1});
+    }
+
+    void uniformVec3(GLint location, float x, float y, float z) {
+        const float value[3] = {x, y, z};
+        uniformVec3(location, value);
+    }
+
+    void uniformInt(GLint location, int value) {
+        commands.push_back({RenderOp::UniformInt, location, (uint32_t)value, 0, 0});
+    }
+
+    void bindTexture(int unit, GLuint texture) {
+        commands.push_back({RenderOp::BindTexture, unit, texture, 0, 0});
+    }
+
+    void drawArrays(GLuint vao, int first, int count) {
+        commands.push_back({RenderOp::DrawArrays, 0, vao, (uint32_t)first, (uint32_t)count});
+    }
+
+    // Segmento de overlay en coordenadas NDC con color RGB.
+    void overlayLine(float x0, float y0, float x1, float y1, const float color[3]) {
+        const float vertices[10] = {x0, y0, color[0], color[1], color[2],
+                                    x1, y1, color[0], color[1], color[2]};
+        overlayVertices.insert(overlayVertices.end(), vertices, vertices + 10);
+    }
+
+    const std::vector<float>& overlay() const { return overlayVertices; }
+    bool empty() const { return commands.empty(); }
+
+    // true si ejecutar esta lista produce la misma imagen que other: mismos comandos
+    // y uniformes y overlay que no difieren en más de epsilon (ruido de la pose).
+    bool sameAs(const RenderCommandList& other, float epsilon) const {
+        if (modelVisible != other.modelVisible || commands.size() != other.commands.size() ||
+            uniformData.size() != other.uniformData.size() || overlayVertices.size() != other.overlayVertices.size())
+            return false;
+        if (modelVisible && std::memcmp(modelRect, other.modelRect, sizeof(modelRect)) != 0) return false;
+        // Campo a campo: RenderCommand tiene relleno sin inicializar tras op.
+        for (size_t i = 0; i < commands.size(); ++i) {
+            const RenderCommand& a = commands[i];
+            const RenderCommand& b = other.commands[i];
+            if (a.op != b.op || a.location != b.location || a.object != b.object || a.offset != b.offset ||
+                a.count != b.count)
+                return false;
+        }
+        return nearlyEqual(uniformData, other.uniformData, epsilon) &&
+               nearlyEqual(overlayVertices, other.overlayVertices, epsilon);
+    }
+
+    // Solo en el hilo con el contexto GL activo.
+    void execute() const {
+        for (const RenderCommand& c : commands) {
+            switch (c.op) {
+                case RenderOp::UseProgram:
+                    glUseProgram(c.object);
+                    break;
+                case RenderOp::UniformMat4:
+                    glUniformMatrix4fv(c.location, 1, GL_FALSE, &uniformData[c.offset]);
+                    break;
+                case RenderOp::UniformVec3:
+                    glUniform3fv(c.location, 1, &uniformData[c.offset]);
+                    break;
+                case RenderOp::UniformInt:
+                    glUniform1i(c.location, (GLint)c.object);
+                    break;
+                case RenderOp::BindTexture:
+                    glActiveTexture(GL_TEXTURE0 + c.location);
+                    glBindTexture(GL_TEXTURE_2D, c.object);
+                    glActiveTexture(GL_TEXTURE0);
+                    break;
+                case RenderOp::DrawArrays:
+                    glBindVertexArray(c.object);
+                    glDrawArrays(GL_TRIANGLES, (GLint)c.offset, (GLsizei)c.count);
+                    glBindVertexArray(0);
+                    break;
+            }
+        }
+    }
+
+private:
+    std::vector<RenderCommand> commands;
+    std::vector<float> uniformData;
+    std::vector<float> overlayVertices; // x, y, r, g, b por vértice
+
+    static bool nearlyEqual(const std::vector<float>& a, const std::vector<float>& b, float epsilon) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (std::fabs(a[i] - b[i]) > epsilon) return false;
+        }
+        return true;
+    }
+
+    uint32_t appendFloats(const float* value, size_t count) {
+        const uint32_t offset = (uint32_t)uniformData.size();
+        uniformData.insert(uniformData.end(), value, value + count);
+        return offset;
+    }
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+// Categorías de memoria contabilizadas (GPU y CPU).
+enum class ResourceCategory {
+    GpuVertexBuffers,  // VBOs de modelos, fondo y overlay
+    GpuTextures,       // texturas de modelos y del fondo
+    GpuRenderTargets,  // FBOs (pase reducido, salida fuera de pantalla)
+    FrameBuffers,      // fotogramas de cámara en los paquetes reciclados
+    VisionTemporaries, // temporales de HSV, máscaras, etc.
+    ModelStaging,      // datos de tinyobj y vértices antes de subirlos
+    IoBuffers,         // búferes alineados de la escritura asíncrona a disco
+    Count
+};
+
+// --- Contabilidad de memoria por categoría (bytes vivos y pico) ---
+// Los objetos GL se registran por nombre para poder descontarlos al borrarlos;
+// los buffers de CPU agrupados usan TrackedAllocation.
+class ResourceTracker {
+public:
+    struct CategoryStats {
+        size_t liveBytes = 0;
+        size_t peakBytes = 0;
+        long long allocations = 0;
+    };
+
+    static ResourceTracker& instance() {
+        static ResourceTracker tracker;
+        return tracker;
+    }
+
+    void allocate(ResourceCategory category, size_t bytes) {
+        const int c = (int)category;
+        const size_t now = live[c].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t previousPeak = peak[c].load(std::memory_order_relaxed);
+        while (now > previousPeak && !peak[c].compare_exchange_weak(previousPeak, now, std::memory_order_relaxed)) {
+        }
+        allocations[c].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release(ResourceCategory category, size_t bytes) {
+        live[(int)category].fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    // Registra (o actualiza) el tamaño de un buffer o textura de GL.
+    void trackGLObject(bool texture, uint32_t name, ResourceCategory category, size_t bytes) {
+        if (name == 0) return;
+        std::lock_guard<std::mutex> lock(glMutex);
+        GLObject& object = glObjects[key(texture, name)];
+        if (object.bytes) release(object.category, object.bytes);
+        object.category = category;
+        object.bytes = bytes;
+        allocate(category, bytes);
+    }
+
+    void untrackGLObject(bool texture, uint32_t name) {
+        if (name == 0) return;
+        std::lock_guard<std::mutex> lock(glMutex);
+        auto it = glObjects.find(key(texture, name));
+        if (it == glObjects.end()) return;
+        release(it->second.category, it->second.bytes);
+        glObjects.erase(it);
+    }
+
+    CategoryStats stats(ResourceCategory category) const {
+        const int c = (int)category;
+        return {live[c].load(), peak[c].load(), allocations[c].load()};
+    }
+
+    void printReport(std::ostream& out = std::cout) const {
+        out << "--- MEMORIA POR CATEGORÍA (KB vivos / pico) ---" << std::endl;
+        for (int c = 0; c < (int)ResourceCategory::Count; ++c) {
+            const CategoryStats s = stats((ResourceCategory)c);
+            out << name((ResourceCategory)c) << ": " << s.liveBytes / 1024 << " / " << s.peakBytes / 1024
+                << " (" << s.allocations << " reservas)" << std::endl;
+        }
+    }
+
+    static const char* name(ResourceCategory category) {
+        switch (category) {
+            case ResourceCategory::GpuVertexBuffers: return "GPU buffers de vértices";
+            case ResourceCategory::GpuTextures: return "GPU texturas";
+            case ResourceCategory::GpuRenderTargets: return "GPU render targets";
+            case ResourceCategory::FrameBuffers: return "CPU fotogramas";
+            case ResourceCategory::VisionTemporaries: return "CPU temporales de visión";
+            case ResourceCategory::ModelStaging: return "CPU carga de modelos";
+            case ResourceCategory::IoBuffers: return "CPU búferes de escritura";
+            default: return "?";
+        }
+    }
+
+    // Volcado bajo demanda: la señal solo levanta una bandera y el bucle principal
+    // imprime el reporte fuera del manejador.
+    static void installDumpSignal(int signal = SIGUSR1) {
+        std::signal(signal, [](int) { dumpRequested.store(true); });
+    }
+
+    bool consumeDumpRequest() {
+        return dumpRequested.exchange(false);
+    }
+
+private:
+    struct GLObject {
+        ResourceCategory category = ResourceCategory::GpuVertexBuffers;
+        size_t bytes = 0;
+    };
+
+    static constexpr int categoryCount = (int)ResourceCategory::Count;
+    std::atomic<size_t> live[categoryCount] = {};
+    std::atomic<size_t> peak[categoryCount] = {};
+    std::atomic<long long> allocations[categoryCount] = {};
+
+    std::mutex glMutex;
+    std::unordered_map<uint64_t, GLObject> glObjects;
+    static inline std::atomic<bool> dumpRequested{false};
+
+    static uint64_t key(bool texture, uint32_t name) {
+        return ((uint64_t)texture << 32) | name;
+    }
+};
+
+// Bytes de un buffer de CPU reutilizado; solo toca los contadores cuando cambia de tamaño.
+class TrackedAllocation {
+public:
+    explicit TrackedAllocation(ResourceCategory category) : category(category) {}
+    ~TrackedAllocation() { set(0); }
+    TrackedAllocation(const TrackedAllocation&) = delete;
+    TrackedAllocation& operator=(const TrackedAllocation&) = delete;
+
+    void set(size_t newBytes) {
+        if (newBytes == bytes) return;
+        if (bytes) ResourceTracker::instance().release(category, bytes);
+        if (newBytes) ResourceTracker::instance().allocate(category, newBytes);
+        bytes = newBytes;
+    }
+
+private:
+    ResourceCategory category;
+    size_t bytes = 0;
+};
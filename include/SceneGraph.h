@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// --- Grafo de escena en arreglos planos (ancla del marcador -> objeto -> submalla) ---
+// Cada nodo guarda su transformación local y la del mundo. Cambiar una local solo
+// marca el nodo como sucio; update() recalcula únicamente los subárboles sucios, así
+// que el coste es proporcional a lo que cambió y no al tamaño de la jerarquía.
+class SceneGraph {
+public:
+    using NodeId = uint32_t;
+    static constexpr NodeId invalidNode = UINT32_MAX;
+
+    NodeId addNode(NodeId parent = invalidNode, const glm::mat4& local = glm::mat4(1.0f)) {
+        const NodeId id = (NodeId)parents.size();
+        parents.push_back(parent);
+        firstChild.push_back(invalidNode);
+        nextSibling.push_back(invalidNode);
+        locals.push_back(local);
+        worlds.push_back(local);
+        dirty.push_back(0);
+
+        if (parent != invalidNode) {
+            nextSibling[id] = firstChild[parent];
+            firstChild[parent] = id;
+        }
+        markDirty(id);
+        return id;
+    }
+
+    void setLocal(NodeId id, const glm::mat4& local) {
+        locals[id] = local;
+        markDirty(id);
+    }
+
+    const glm::mat4& local(NodeId id) const { return locals[id]; }
+    const glm::mat4& world(NodeId id) const { return worlds[id]; }
+    size_t size() const { return parents.size(); }
+
+    // Recalcula las matrices del mundo de los subárboles sucios. Devuelve cuántos
+    // nodos se recalcularon.
+    size_t update() {
+        size_t updated = 0;
+        for (NodeId root : dirtyRoots) {
+            // Ya procesado dentro del subárbol de otro nodo sucio.
+            if (!dirty[root]) continue;
+            // Un ancestro sucio recalculará este subárbol entero.
+            if (hasDirtyAncestor(root)) continue;
+
+            stack.clear();
+            stack.push_back(root);
+            while (!stack.empty()) {
+                const NodeId id = stack.back();
+                stack.pop_back();
+                const NodeId parent = parents[id];
+                worlds[id] = parent == invalidNode ? locals[id] : worlds[parent] * locals[id];
+                dirty[id] = 0;
+                ++updated;
+                for (NodeId child = firstChild[id]; child != invalidNode; child = nextSibling[child]) {
+                    stack.push_back(child);
+                }
+            }
+        }
+        dirtyRoots.clear();
+        return updated;
+    }
+
+private:
+    std::vector<NodeId> parents, firstChild, nextSibling;
+    std::vector<glm::mat4> locals, worlds;
+    std::vector<uint8_t> dirty;
+    std::vector<NodeId> dirtyRoots;
+    std::vector<NodeId> stack;
+
+    void markDirty(NodeId id) {
+        if (dirty[id]) return;
+        dirty[id] = 1;
+        dirtyRoots.push_back(id);
+    }
+
+    bool hasDirtyAncestor(NodeId id) const {
+        for (NodeId parent = parents[id]; parent != invalidNode; parent = parents[parent]) {
+            if (dirty[parent]) return true;
+        }
+        return false;
+    }
+};
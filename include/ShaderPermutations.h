@@ -0,0 +1,96 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GpuUploader.h>
+
+// glad se generó sin extensiones: enum de KHR_parallel_shader_compile a mano.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// --- Variantes de un shader armadas a partir de banderas de características ---
+// Los cuerpos GLSL no llevan #version: cada variante se arma anteponiendo la
+// versión y un #define por bandera activa, y el cuerpo elige con #ifdef. La variante
+// básica (sin banderas) se compila al iniciar y debe servir para todo; las
+// especializadas se piden con request() y se compilan sin detener el render:
+//   - con KHR/ARB_parallel_shader_compile, en los hilos del driver: se lanza el
+//     enlazado y poll() consulta GL_COMPLETION_STATUS_KHR sin bloquear;
+//   - si no, en el hilo de subidas (contexto compartido) si está activo;
+//   - si no, de una en una por fotograma en el hilo de GL.
+// Mientras una variante no está lista, select() devuelve la básica.
+//
+// init(), request(), poll() y destroy() van en el hilo de GL; select() se puede
+// llamar desde los hilos que graban comandos.
+class ShaderPermutations {
+public:
+    struct Variant {
+        GLuint program = 0;
+        std::vector<GLint> uniforms; // en el orden de uniformNames
+    };
+
+    // featureDefines[i] es el #define de la bandera 1 << i.
+    ShaderPermutations(std::string name, const char* vertexBody, const char* fragmentBody,
+                       std::vector<std::string> featureDefines, std::vector<std::string> uniformNames);
+    ~ShaderPermutations() = default;
+
+    ShaderPermutations(const ShaderPermutations&) = delete;
+    ShaderPermutations& operator=(const ShaderPermutations&) = delete;
+
+    // Compila la variante básica; false si falla.
+    bool init();
+    // true si el driver compila en paralelo (se sabe después de init()).
+    bool parallelCompile() const { return parallel; }
+    // Empieza a compilar una variante; no hace nada si ya se pidió.
+    void request(uint32_t features, GpuUploader* worker = nullptr);
+    // Recoge las variantes terminadas.
+    void poll();
+    const Variant& select(uint32_t features) const;
+    void destroy();
+
+    void printReport() const;
+
+    // Programa a partir de fuentes completas, compilado y enlazado en el momento.
+    static GLuint buildProgram(const char* vertexSource, const char* fragmentSource, const std::string& label);
+
+private:
+    enum class State { Idle, Compiling, Ready, Failed };
+    enum class Mode { Sync, Parallel, Worker };
+
+    struct Slot {
+        Variant variant;
+        std::atomic<bool> ready{false};
+        // Solo el hilo de GL.
+        State state = State::Idle;
+        Mode mode = Mode::Sync;
+        GLuint vertexShader = 0, fragmentShader = 0, program = 0;
+        GpuUploader* worker = nullptr;
+        GpuUploader::Ticket ticket = 0;
+        std::shared_ptr<GLuint> workerProgram;
+        std::chrono::steady_clock::time_point requested;
+        double readyMs = 0.0;
+    };
+
+    std::string name;
+    const char* vertexBody;
+    const char* fragmentBody;
+    std::vector<std::string> featureDefines;
+    std::vector<std::string> uniformNames;
+    std::unique_ptr<Slot[]> slots;
+    uint32_t slotCount = 0;
+    bool parallel = false;
+    double basicCompileMs = 0.0;
+
+    std::string source(const char* body, uint32_t features) const;
+    std::string featureLabel(uint32_t features) const;
+    void finish(uint32_t features, GLuint program);
+
+    static bool parallelCompileSupported();
+    static bool linkSucceeded(GLuint program, const std::string& label);
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <AsyncFileWriter.h>
+
+// --- Traza del arranque en formato Chrome Trace Event (chrome://tracing, Perfetto) ---
+// Cada tarea de arranque registra un intervalo con el hilo que la ejecutó; finish()
+// cierra el intervalo total (hasta el primer fotograma presentado) y escribe el JSON.
+class StartupTrace {
+public:
+    void begin(std::string outputPath) {
+        std::lock_guard<std::mutex> lock(mutex);
+        path = std::move(outputPath);
+        origin = std::chrono::steady_clock::now();
+        spans.clear();
+        threads.assign(1, std::this_thread::get_id()); // el hilo principal es el 0
+        active = true;
+    }
+
+    // Intervalo con alcance: se registra al destruirse.
+    class Span {
+    public:
+        Span(StartupTrace& trace, const char* name)
+            : trace(trace), name(name), start(std::chrono::steady_clock::now()) {}
+        ~Span() { trace.record(name, start, std::chrono::steady_clock::now()); }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        StartupTrace& trace;
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Lanza una tarea independiente del arranque en su propio hilo.
+    template <typename F>
+    auto launch(const char* name, F&& task) {
+        return std::async(std::launch::async, [this, name, task = std::forward<F>(task)]() mutable {
+            Span span(*this, name);
+            return task();
+        });
+    }
+
+    void record(const char* name, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!active) return;
+        spans.push_back({name, threadIndex(std::this_thread::get_id()), micros(start), micros(end) - micros(start)});
+    }
+
+    // Idempotente: solo el primer llamado escribe la traza. Se llama una vez, justo
+    // después del primer fotograma presentado; el flujo se cierra en seguida para que
+    // la traza quede completa en disco aunque la ejecución termine mal después.
+    void finish(AsyncFileWriter& writer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!active) return;
+        active = false;
+        const long long total = micros(std::chrono::steady_clock::now());
+        spans.push_back({"startup", 0, 0, total});
+
+        std::ostringstream out;
+        out << "{\"traceEvents\":[\n";
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const SpanRecord& s = spans[i];
+            out << "  {\"name\":\"" << s.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << s.thread
+                << ",\"ts\":" << s.startUs << ",\"dur\":" << s.durationUs << "}"
+                << (i + 1 < spans.size() ? ",\n" : "\n");
+        }
+        out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+        const int stream = writer.open(path);
+        const bool written = stream >= 0 && writer.write(stream, out.str());
+        if (stream >= 0) writer.close(stream);
+        if (!written) {
+            std::cerr << "Error: No se pudo escribir la traza de arranque " << path << std::endl;
+        }
+        std::cout << "Arranque en frío: " << total / 1000.0 << " ms hasta el primer fotograma (traza: "
+                  << path << ")" << std::endl;
+    }
+
+private:
+    struct SpanRecord {
+        const char* name;
+        int thread;
+        long long startUs, durationUs;
+    };
+
+    std::mutex mutex;
+    std::string path;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<SpanRecord> spans;
+    std::vector<std::thread::id> threads;
+    bool active = false;
+
+    long long micros(std::chrono::steady_clock::time_point t) const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - origin).count();
+    }
+
+    int threadIndex(std::thread::id id) {
+        for (size_t i = 0; i < threads.size(); ++i) {
+            if (threads[i] == id) return (int)i;
+        }
+        threads.push_back(id);
+        return (int)threads.size() - 1;
+    }
+};
@@ -0,0 +1,511 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// glad se generó sin extensiones: definimos los enums de S3TC a mano.
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// --- Resultado de cargar una textura (para reportar memoria y tiempos) ---
+struct TextureLoadInfo {
+    GLuint texture = 0;
+    GLenum format = 0;          // formato interno subido a la GPU
+    int width = 0, height = 0;
+    int mipLevels = 0;
+    size_t gpuBytes = 0;        // bytes de todos los mips tal como viven en la GPU
+    size_t rawBytes = 0;        // bytes equivalentes en RGBA8 sin comprimir
+    double loadMs = 0.0;
+    bool fromCache = false;
+    bool compressed = false;
+};
+
+// Carga texturas de modelos comprimiéndolas una sola vez a BC1/BC3 (S3TC).
+// El resultado (con todos sus mips) se guarda en disco con la clave del hash
+// del archivo fuente, de modo que las siguientes ejecuciones suben los bloques
+// comprimidos directamente. Si el driver no soporta S3TC se sube RGBA8.
+class TextureCache {
+public:
+    explicit TextureCache(std::string cacheDir = ".texcache") : cacheDir(std::move(cacheDir)) {}
+
+    struct MipLevel {
+        int width = 0, height = 0;
+        std::vector<uint8_t> data;
+    };
+
+    // Textura lista para subir: lectura, hash, caché y compresión ya resueltos.
+    // Se prepara sin contexto GL, así que puede hacerse en otro hilo.
+    struct PreparedTexture {
+        std::string path;
+        bool valid = false;
+        bool fromCache = false;
+        GLenum format = 0;            // formato S3TC de levels (0 si no se comprimió)
+        std::vector<MipLevel> levels;
+        cv::Mat rgba;                 // imagen decodificada (vacía si vino de la caché)
+        std::vector<uchar> fileBytes; // se conserva para decodificar si al final no hay S3TC
+        double prepareMs = 0.0;
+    };
+
+    GLuint load(const std::string& path, TextureLoadInfo* outInfo = nullptr) {
+        PreparedTexture prepared;
+        if (!prepare(path, s3tcSupported(), prepared)) return 0;
+        return upload(prepared, outInfo);
+    }
+
+    // Parte de CPU de load(). compress indica si se espera subir S3TC; antes de tener
+    // contexto no se puede consultar, y lo habitual en escritorio es que esté.
+    bool prepare(const std::string& path, bool compress, PreparedTexture& out) const {
+        auto start = std::chrono::steady_clock::now();
+        out = PreparedTexture();
+        out.path = path;
+
+        if (!readFile(path, out.fileBytes)) {
+            std::cerr << "Error: No se pudo leer la textura " << path << std::endl;
+            return false;
+        }
+
+        const std::string cachePath = cacheFilePath(hashBytes(out.fileBytes));
+        if (compress && readCache(cachePath, out.format, out.levels)) {
+            out.fromCache = true;
+        } else {
+            bool hasAlpha = false;
+            if (!decodeRGBA(out.fileBytes, out.rgba, hasAlpha)) {
+                std::cerr << "Error: No se pudo decodificar la textura " << path << std::endl;
+                return false;
+            }
+            if (compress) {
+                out.format = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                buildCompressedMips(out.rgba, out.format, out.levels);
+                writeCache(cachePath, out.format, out.levels);
+            }
+        }
+        out.valid = true;
+        out.prepareMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    // Parte de GL de load(); requiere el contexto activo.
+    GLuint upload(PreparedTexture& prepared, TextureLoadInfo* outInfo = nullptr) {
+        if (!prepared.valid) return 0;
+        auto start = std::chrono::steady_clock::now();
+        TextureLoadInfo info;
+        info.fromCache = prepared.fromCache;
+
+        const bool compress = !prepared.levels.empty() && s3tcSupported();
+        if (!compress && prepared.rgba.empty()) {
+            bool hasAlpha = false;
+            if (!decodeRGBA(prepared.fileBytes, prepared.rgba, hasAlpha)) {
+                std::cerr << "Error: No se pudo decodificar la textura " << prepared.path << std::endl;
+                return 0;
+            }
+        }
+        GLenum format = prepared.format;
+        const std::vector<MipLevel>& levels = prepared.levels;
+        const cv::Mat& rgba = prepared.rgba;
+
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        if (compress) {
+            for (size_t level = 0; level < levels.size(); ++level) {
+                const MipLevel& mip = levels[level];
+                glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format, mip.width, mip.height, 0,
+                                       (GLsizei)mip.data.size(), mip.data.data());
+                info.gpuBytes += mip.data.size();
+                info.rawBytes += (size_t)mip.width * mip.height * 4;
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+            info.width = levels[0].width;
+            info.height = levels[0].height;
+            info.mipLevels = (int)levels.size();
+            info.compressed = true;
+        } else {
+            // Respaldo: RGBA8 sin comprimir, mips generados por el driver.
+            format = GL_RGBA8;
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, rgba.cols, rgba.rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            info.width = rgba.cols;
+            info.height = rgba.rows;
+            info.mipLevels = mipCount(rgba.cols, rgba.rows);
+            info.rawBytes = mipChainBytes(rgba.cols, rgba.rows);
+            info.gpuBytes = info.rawBytes;
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        info.texture = texture;
+        info.format = format;
+        info.loadMs = prepared.prepareMs +
+                      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalGpu += info.gpuBytes;
+        totalRaw += info.rawBytes;
+
+        std::cout << "Textura cargada: " << prepared.path << " (" << info.width << "x" << info.height
+                  << ", " << formatName(format) << ", " << info.mipLevels << " mips"
+                  << (info.fromCache ? ", desde caché" : "") << ") "
+                  << (info.gpuBytes / 1024) << " KB en GPU (sin comprimir: " << (info.rawBytes / 1024)
+                  << " KB) en " << info.loadMs << " ms" << std::endl;
+
+        if (outInfo) *outInfo = info;
+        return texture;
+    }
+
+    // Mip ya comprimido que vive en memoria ajena (p. ej. un paquete proyectado).
+    struct MipLevelView {
+        int width = 0, height = 0;
+        const uint8_t* data = nullptr;
+        size_t bytes = 0;
+    };
+
+    // Sube una cadena de mips S3TC sin copiarla ni pasar por la caché. Requiere
+    // S3TC (s3tcSupported()) y el contexto activo.
+    GLuint uploadCompressed(const std::string& name, GLenum format, const std::vector<MipLevelView>& levels,
+                            TextureLoadInfo* outInfo = nullptr) {
+        if (levels.empty()) return 0;
+        auto start = std::chrono::steady_clock::now();
+        TextureLoadInfo info;
+
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        for (size_t level = 0; level < levels.size(); ++level) {
+            const MipLevelView& mip = levels[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, format, mip.width, mip.height, 0, (GLsizei)mip.bytes,
+                                   mip.data);
+            info.gpuBytes += mip.bytes;
+            info.rawBytes += (size_t)mip.width * mip.height * 4;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        info.texture = texture;
+        info.format = format;
+        info.width = levels[0].width;
+        info.height = levels[0].height;
+        info.mipLevels = (int)levels.size();
+        info.compressed = true;
+        info.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalGpu += info.gpuBytes;
+        totalRaw += info.rawBytes;
+
+        std::cout << "Textura cargada: " << name << " (" << info.width << "x" << info.height << ", "
+                  << formatName(format) << ", " << info.mipLevels << " mips, desde paquete) "
+                  << (info.gpuBytes / 1024) << " KB en GPU en " << info.loadMs << " ms" << std::endl;
+
+        if (outInfo) *outInfo = info;
+        return texture;
+    }
+
+    size_t totalGpuBytes() const { return totalGpu; }
+    size_t totalRawBytes() const { return totalRaw; }
+
+    // Requiere un contexto GL activo.
+    static bool s3tcSupported() {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (ext && std::strcmp(ext, "GL_EXT_texture_compression_s3tc") == 0) return true;
+        }
+        return false;
+    }
+
+private:
+    static constexpr uint32_t cacheMagic = 0x43545241; // "ARTC"
+    static constexpr uint32_t cacheVersion = 1;
+    static constexpr uint32_t maxCacheLevels = 16;        // cadena completa de 32768x32768
+    static constexpr uint32_t maxCacheDimension = 32768;
+
+    std::string cacheDir;
+    size_t totalGpu = 0, totalRaw = 0;
+
+    static bool readFile(const std::string& path, std::vector<uchar>& bytes) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        bytes.resize((size_t)file.tellg());
+        file.seekg(0);
+        return (bool)file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    }
+
+    // FNV-1a de 64 bits sobre el archivo fuente.
+    static uint64_t hashBytes(const std::vector<uchar>& bytes) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (uchar b : bytes) {
+            hash ^= b;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    std::string cacheFilePath(uint64_t hash) const {
+        std::ostringstream name;
+        name << std::hex << hash << ".artc";
+        return (std::filesystem::path(cacheDir) / name.str()).string();
+    }
+
+    static bool decodeRGBA(const std::vector<uchar>& bytes, cv::Mat& rgba, bool& hasAlpha) {
+        cv::Mat image = cv::imdecode(bytes, cv::IMREAD_UNCHANGED);
+        if (image.empty()) return false;
+        if (image.depth() != CV_8U) image.convertTo(image, CV_8U, 1.0 / 257.0);
+
+        hasAlpha = false;
+        if (image.channels() == 1) {
+            cv::cvtColor(image, rgba, cv::COLOR_GRAY2RGBA);
+        } else if (image.channels() == 3) {
+            cv::cvtColor(image, rgba, cv::COLOR_BGR2RGBA);
+        } else {
+            cv::cvtColor(image, rgba, cv::COLOR_BGRA2RGBA);
+            double minAlpha = 255.0;
+            std::vector<cv::Mat> channels;
+            cv::split(rgba, channels);
+            cv::minMaxLoc(channels[3], &minAlpha);
+            hasAlpha = minAlpha < 255.0;
+        }
+        // Las coordenadas UV de OBJ tienen el origen abajo a la izquierda.
+        cv::flip(rgba, rgba, 0);
+        return true;
+    }
+
+    static int mipCount(int width, int height) {
+        int levels = 1;
+        while (width > 1 || height > 1) {
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+            ++levels;
+        }
+        return levels;
+    }
+
+    static size_t mipChainBytes(int width, int height) {
+        size_t bytes = 0;
+        for (int level = 0; level < mipCount(width, height); ++level) {
+            bytes += (size_t)width * height * 4;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        return bytes;
+    }
+
+    static void buildCompressedMips(const cv::Mat& rgba, GLenum format, std::vector<MipLevel>& levels) {
+        const bool bc3 = (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+        const size_t blockBytes = bc3 ? 16 : 8;
+        levels.clear();
+
+        cv::Mat level = rgba;
+        while (true) {
+            MipLevel mip;
+            mip.width = level.cols;
+            mip.height = level.rows;
+            const int blocksX = (level.cols + 3) / 4;
+            const int blocksY = (level.rows + 3) / 4;
+            mip.data.resize((size_t)blocksX * blocksY * blockBytes);
+
+            uint8_t block[64];
+            uint8_t* out = mip.data.data();
+            for (int by = 0; by < blocksY; ++by) {
+                for (int bx = 0; bx < blocksX; ++bx) {
+                    // Los bordes se completan repitiendo el último píxel.
+                    for (int y = 0; y < 4; ++y) {
+                        const uint8_t* row = level.ptr<uint8_t>(std::min(by * 4 + y, level.rows - 1));
+                        for (int x = 0; x < 4; ++x) {
+                            const int px = std::min(bx * 4 + x, level.cols - 1);
+                            std::memcpy(block + (y * 4 + x) * 4, row + px * 4, 4);
+                        }
+                    }
+                    if (bc3) {
+                        compressAlphaBlock(block, out);
+                        compressColorBlock(block, out + 8);
+                    } else {
+                        compressColorBlock(block, out);
+                    }
+                    out += blockBytes;
+                }
+            }
+            levels.push_back(std::move(mip));
+
+            if (level.cols == 1 && level.rows == 1) break;
+            cv::Mat next;
+            cv::resize(level, next, cv::Size(std::max(1, level.cols / 2), std::max(1, level.rows / 2)), 0, 0, cv::INTER_AREA);
+            level = next;
+        }
+    }
+
+    static uint16_t packRGB565(const int c[3]) {
+        return (uint16_t)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+    }
+
+    static void unpackRGB565(uint16_t v, int c[3]) {
+        c[0] = ((v >> 11) & 31) * 255 / 31;
+        c[1] = ((v >> 5) & 63) * 255 / 63;
+        c[2] = (v & 31) * 255 / 31;
+    }
+
+    // Bloque de color BC1: extremos de la caja envolvente con un pequeño inset.
+    static void compressColorBlock(const uint8_t block[64], uint8_t out[8]) {
+        int minC[3] = {255, 255, 255}, maxC[3] = {0, 0, 0};
+        for (int i = 0; i < 16; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                minC[c] = std::min(minC[c], (int)block[i * 4 + c]);
+                maxC[c] = std::max(maxC[c], (int)block[i * 4 + c]);
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            const int inset = (maxC[c] - minC[c]) >> 4;
+            minC[c] = std::min(255, minC[c] + inset);
+            maxC[c] = std::max(0, maxC[c] - inset);
+        }
+
+        uint16_t c0 = packRGB565(maxC), c1 = packRGB565(minC);
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            // En BC1 el modo de 4 colores exige c0 > c1 (BC3 lo ignora).
+            if (c0 < c1) std::swap(c0, c1);
+            int palette[4][3];
+            unpackRGB565(c0, palette[0]);
+            unpackRGB565(c1, palette[1]);
+            for (int c = 0; c < 3; ++c) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            for (int i = 0; i < 16; ++i) {
+                int best = 0, bestDist = INT32_MAX;
+                for (int p = 0; p < 4; ++p) {
+                    int dist = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        const int d = block[i * 4 + c] - palette[p][c];
+                        dist += d * d;
+                    }
+                    if (dist < bestDist) {
+                        bestDist = dist;
+                        best = p;
+                    }
+                }
+                indices |= (uint32_t)best << (2 * i);
+            }
+        }
+        out[0] = c0 & 0xFF;
+        out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF;
+        out[3] = c1 >> 8;
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    // Bloque de alfa BC3: interpolación de 8 valores entre el máximo y el mínimo.
+    static void compressAlphaBlock(const uint8_t block[64], uint8_t out[8]) {
+        int minA = 255, maxA = 0;
+        for (int i = 0; i < 16; ++i) {
+            minA = std::min(minA, (int)block[i * 4 + 3]);
+            maxA = std::max(maxA, (int)block[i * 4 + 3]);
+        }
+        out[0] = (uint8_t)maxA;
+        out[1] = (uint8_t)minA;
+
+        uint64_t bits = 0;
+        if (maxA != minA) {
+            int palette[8];
+            palette[0] = maxA;
+            palette[1] = minA;
+            for (int p = 1; p < 7; ++p) palette[p + 1] = ((7 - p) * maxA + p * minA) / 7;
+            for (int i = 0; i < 16; ++i) {
+                int best = 0, bestDist = 256;
+                for (int p = 0; p < 8; ++p) {
+                    const int dist = std::abs(block[i * 4 + 3] - palette[p]);
+                    if (dist < bestDist) {
+                        bestDist = dist;
+                        best = p;
+                    }
+                }
+                bits |= (uint64_t)best << (3 * i);
+            }
+        }
+        for (int b = 0; b < 6; ++b) out[2 + b] = (uint8_t)(bits >> (8 * b));
+    }
+
+    // Todo lo que viene del disco se valida antes de reservar: un archivo corrupto o
+    // truncado no puede pedir más memoria de la que ocupa ni tamaños que no cuadren con
+    // los bloques de 4x4 del formato. Cualquier fallo hace regenerar la caché.
+    bool readCache(const std::string& path, GLenum& format, std::vector<MipLevel>& levels) const {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        const std::streamoff fileSize = file.tellg();
+        file.seekg(0);
+        uint32_t header[4] = {};
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+        if (header[0] != cacheMagic || header[1] != cacheVersion || header[3] == 0 ||
+            header[3] > maxCacheLevels)
+            return false;
+        if (header[2] != GL_COMPRESSED_RGB_S3TC_DXT1_EXT && header[2] != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+            return false;
+
+        format = header[2];
+        const size_t blockBytes = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT ? 16 : 8;
+        levels.resize(header[3]);
+        for (MipLevel& mip : levels) {
+            uint32_t dims[3] = {};
+            if (!file.read(reinterpret_cast<char*>(dims), sizeof(dims))) return false;
+            if (dims[0] == 0 || dims[1] == 0 || dims[0] > maxCacheDimension || dims[1] > maxCacheDimension)
+                return false;
+            const size_t expected = (size_t)((dims[0] + 3) / 4) * ((dims[1] + 3) / 4) * blockBytes;
+            if (dims[2] != expected || (std::streamoff)dims[2] > fileSize - (std::streamoff)file.tellg())
+                return false;
+            mip.width = (int)dims[0];
+            mip.height = (int)dims[1];
+            mip.data.resize(dims[2]);
+            if (!file.read(reinterpret_cast<char*>(mip.data.data()), dims[2])) return false;
+        }
+        return true;
+    }
+
+    void writeCache(const std::string& path, GLenum format, const std::vector<MipLevel>& levels) const {
+        std::error_code ec;
+        std::filesystem::create_directories(cacheDir, ec);
+        // Se escribe a un temporal y se renombra para no dejar cachés a medias.
+        const std::string tmpPath = path + ".tmp";
+        std::ofstream file(tmpPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "Advertencia: No se pudo escribir la caché de texturas en " << cacheDir << std::endl;
+            return;
+        }
+        const uint32_t header[4] = {cacheMagic, cacheVersion, (uint32_t)format, (uint32_t)levels.size()};
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const MipLevel& mip : levels) {
+            const uint32_t dims[3] = {(uint32_t)mip.width, (uint32_t)mip.height, (uint32_t)mip.data.size()};
+            file.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+            file.write(reinterpret_cast<const char*>(mip.data.data()), mip.data.size());
+        }
+        file.close();
+        std::filesystem::rename(tmpPath, path, ec);
+    }
+
+    static const char* formatName(GLenum format) {
+        switch (format) {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+            default: return "RGBA8";
+        }
+    }
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <opencv2/aruco.hpp>
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <FrameSource.h>
+#include <HandGestureDetector.h>
+
+// Resultado de un fotograma a lo largo de las etapas de visión. Se reutiliza entre
+// fotogramas para no reservar memoria en cada uno.
+struct VisionFrame {
+    cv::Mat image;
+    double scale = 1.0; // tamaño de image / tamaño real (fuentes con decodificación reducida)
+    long long index = -1;
+    std::vector<int> markerIds;
+    std::vector<std::vector<cv::Point2f>> markerCorners; // en coordenadas de resolución completa
+    bool markerFound = false;
+    cv::Vec3d rvec, tvec;              // pose del primer marcador
+    std::vector<cv::Vec3d> rvecs, tvecs; // una por marcador (solo con PnPPoseStage::allMarkers)
+    bool gesture = false;
+};
+
+// --- Pipeline de visión por fotograma compuesto por políticas ---
+// Cada etapa es un tipo con un único método; el pipeline las llama en orden
+// (fuente, detector, pose, gesto, destino) sin llamadas virtuales, de modo que en
+// las configuraciones instanciadas en compilación el compilador puede integrar las
+// fronteras entre etapas y eliminar las vacías (NoSource, NoGesture, NullSink).
+// Para configuraciones decididas en tiempo de ejecución está DynamicVisionPipeline.
+//
+//   Source:     bool read(VisionFrame&)
+//   Detector:   void detect(VisionFrame&)   (rellena markerIds/markerCorners/markerFound)
+//   PoseSolver: void solve(VisionFrame&)    (solo se llama si markerFound)
+//   Gesture:    void detect(VisionFrame&)   (solo se llama si markerFound)
+//   Sink:       void consume(VisionFrame&)
+template <typename Source, typename Detector, typename PoseSolver, typename Gesture, typename Sink>
+class VisionPipeline {
+public:
+    VisionPipeline(Source source, Detector detector, PoseSolver poseSolver, Gesture gesture, Sink sink)
+        : source(std::move(source)), detector(std::move(detector)), poseSolver(std::move(poseSolver)),
+          gesture(std::move(gesture)), sink(std::move(sink)) {}
+
+    // Lee un fotograma de la fuente y lo procesa. false al agotarse la fuente.
+    bool step(VisionFrame& frame) {
+        if (!source.read(frame)) return false;
+        process(frame);
+        return true;
+    }
+
+    // Procesa un fotograma ya presente en frame.image.
+    void process(VisionFrame& frame) {
+        frame.index = ++frameIndex;
+        frame.gesture = false;
+        frame.rvec = cv::Vec3d(0, 0, 0);
+        frame.tvec = cv::Vec3d(0, 0, 0);
+        detector.detect(frame);
+        if (frame.markerFound) {
+            poseSolver.solve(frame);
+            gesture.detect(frame);
+        }
+        sink.consume(frame);
+    }
+
+    Sink& getSink() { return sink; }
+
+private:
+    Source source;
+    Detector detector;
+    PoseSolver poseSolver;
+    Gesture gesture;
+    Sink sink;
+    long long frameIndex = -1;
+};
+
+template <typename Source, typename Detector, typename PoseSolver, typename Gesture, typename Sink>
+VisionPipeline<Source, Detector, PoseSolver, Gesture, Sink> makeVisionPipeline(Source source, Detector detector,
+                                                                               PoseSolver poseSolver, Gesture gesture,
+                                                                               Sink sink) {
+    return {std::move(source), std::move(detector), std::move(poseSolver), std::move(gesture), std::move(sink)};
+}
+
+// --- Etapas ---
+
+// El fotograma lo pone quien llama a process().
+struct NoSource {
+    bool read(VisionFrame&) { return false; }
+};
+
+// Con S final (JpegFrameSource, ParallelVideoFrameSource...) la llamada se desvirtualiza.
+template <typename S>
+struct FrameSourceStage {
+    S* source;
+    bool read(VisionFrame& frame) { return source->readForVision(frame.image, frame.scale); }
+};
+
+struct ArucoDetectorStage {
+    const cv::aruco::ArucoDetector* detector;
+    void detect(VisionFrame& frame) {
+        detector->detectMarkers(frame.image, frame.markerCorners, frame.markerIds);
+        frame.markerFound = !frame.markerIds.empty();
+        if (frame.markerFound && frame.scale != 1.0) {
+            for (std::vector<cv::Point2f>& marker : frame.markerCorners)
+                for (cv::Point2f& corner : marker) corner *= (float)(1.0 / frame.scale);
+        }
+    }
+};
+
+// solvePnP con las esquinas del primer marcador (cuadrado de lado markerLength), o de
+// todos con allMarkers. Sin calibración (matriz vacía) usa intrínsecos aproximados
+// del tamaño del fotograma.
+struct PnPPoseStage {
+    cv::Mat* cameraMatrix;
+    cv::Mat* distCoeffs;
+    bool allMarkers;
+    std::vector<cv::Point3f> objectPoints;
+
+    PnPPoseStage(cv::Mat* cameraMatrix, cv::Mat* distCoeffs, float markerLength, bool allMarkers = false)
+        : cameraMatrix(cameraMatrix), distCoeffs(distCoeffs), allMarkers(allMarkers),
+          objectPoints{cv::Point3f(-markerLength / 2.f, markerLength / 2.f, 0),
+                       cv::Point3f(markerLength / 2.f, markerLength / 2.f, 0),
+                       cv::Point3f(markerLength / 2.f, -markerLength / 2.f, 0),
+                       cv::Point3f(-markerLength / 2.f, -markerLength / 2.f, 0)} {}
+
+    void solve(VisionFrame& frame) {
+        if (cameraMatrix->empty()) {
+            const double width = frame.image.cols / frame.scale, height = frame.image.rows / frame.scale;
+            *cameraMatrix = (cv::Mat_<double>(3, 3) << width, 0, width / 2.0, 0, width, height / 2.0, 0, 0, 1);
+            *distCoeffs = cv::Mat::zeros(1, 5, CV_64F);
+        }
+        cv::solvePnP(objectPoints, frame.markerCorners[0], *cameraMatrix, *distCoeffs, frame.rvec, frame.tvec);
+        if (!allMarkers) return;
+        frame.rvecs.resize(frame.markerCorners.size());
+        frame.tvecs.resize(frame.markerCorners.size());
+        frame.rvecs[0] = frame.rvec;
+        frame.tvecs[0] = frame.tvec;
+        for (size_t i = 1; i < frame.markerCorners.size(); ++i)
+            cv::solvePnP(objectPoints, frame.markerCorners[i], *cameraMatrix, *distCoeffs, frame.rvecs[i], frame.tvecs[i]);
+    }
+};
+
+struct NoGesture {
+    void detect(VisionFrame&) {}
+};
+
+struct HandGestureStage {
+    HandGestureDetector* detector;
+    void detect(VisionFrame& frame) { frame.gesture = detector->detect(frame.image); }
+};
+
+struct NullSink {
+    void consume(VisionFrame&) {}
+};
+
+// Destino a partir de cualquier invocable; con una lambda queda integrado.
+template <typename F>
+struct CallbackSink {
+    F callback;
+    void consume(VisionFrame& frame) { callback(frame); }
+};
+
+template <typename F>
+CallbackSink<F> makeCallbackSink(F callback) {
+    return {std::move(callback)};
+}
+
+// --- Respaldo configurable en tiempo de ejecución ---
+// Cada etapa es un std::function (una llamada indirecta por etapa y fotograma); una
+// etapa vacía se salta. Sirve para combinaciones que no merecen su propia instancia.
+struct DynamicSource {
+    std::function<bool(VisionFrame&)> fn;
+    bool read(VisionFrame& frame) { return fn && fn(frame); }
+};
+
+struct DynamicStage {
+    std::function<void(VisionFrame&)> fn;
+    void detect(VisionFrame& frame) {
+        if (fn) fn(frame);
+    }
+    void solve(VisionFrame& frame) {
+        if (fn) fn(frame);
+    }
+    void consume(VisionFrame& frame) {
+        if (fn) fn(frame);
+    }
+};
+
+using DynamicVisionPipeline = VisionPipeline<DynamicSource, DynamicStage, DynamicStage, DynamicStage, DynamicStage>;
@@ -0,0 +1,1301 @@
+// Implementación de ARRenderer, compilada una sola vez en la biblioteca ar_renderer.
+// tinyobjloader se implementa aquí y no en cada unidad que incluye el renderizador.
+
+#include <ARRenderer.h>
+#include <AssetManager.h>
+
+#include <GLFW/glfw3.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+// Shader del modelo: cuerpos sin #version, ver ShaderPermutations. Las banderas
+// fijan en compilación lo que la variante básica decide por uniforme o calcula
+// en general (ObjectShaderFeature en ARRenderer.h).
+static const char* objectVertexShaderBody = R"(
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in vec3 aNormal;
+    layout (location = 2) in vec2 aTexCoord;
+
+    out vec3 FragPos;
+    out vec3 Normal;
+    out vec2 TexCoord;
+
+    uniform mat4 model;
+    uniform mat4 view;
+    uniform mat4 projection;
+
+    void main() {
+        FragPos = vec3(model * vec4(aPos, 1.0));
+    #ifdef UNIFORM_SCALE
+        // Con escala uniforme la matriz normal es mat3(model) salvo un factor que
+        // normalize() elimina: sin inverse() por vértice.
+        Normal = mat3(model) * aNormal;
+    #else
+        Normal = mat3(transpose(inverse(model))) * aNormal;
+    #endif
+        TexCoord = aTexCoord;
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+    }
+)";
+
+static const char* objectFragmentShaderBody = R"(
+    out vec4 FragColor;
+
+    in vec3 FragPos;
+    in vec3 Normal;
+    in vec2 TexCoord;
+
+    uniform vec3 objectColor;
+    uniform bool useTexture;
+    uniform sampler2D diffuseTexture;
+    uniform vec3 lightColor;
+    uniform vec3 lightPos;
+    uniform vec3 viewPos;
+
+    void main() {
+        // Iluminación Ambiental
+        float ambientStrength = 0.2;
+        vec3 ambient = ambientStrength * lightColor;
+
+        // Iluminación Difusa
+        vec3 norm = normalize(Normal);
+        vec3 lightDir = normalize(lightPos - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor;
+
+        // Iluminación Especular
+        float specularStrength = 0.8;
+        vec3 viewDir = normalize(viewPos - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+        vec3 specular = specularStrength * spec * lightColor;
+
+    #if defined(DIFFUSE_TEXTURE)
+        vec3 baseColor = texture(diffuseTexture, TexCoord).rgb;
+    #elif defined(DIFFUSE_COLOR)
+        vec3 baseColor = objectColor;
+    #else
+        vec3 baseColor = useTexture ? texture(diffuseTexture, TexCoord).rgb : objectColor;
+    #endif
+        vec3 result = (ambient + diffuse + specular) * baseColor;
+        FragColor = vec4(result, 1.0);
+    }
+)";
+
+static const char* backgroundVertexShaderSource = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    out vec2 TexCoord;
+    uniform float depth; // 1.0 = plano lejano (el modelo ya dibujado tapa el fondo)
+    void main() {
+        gl_Position = vec4(aPos, depth, 1.0);
+        TexCoord = aTexCoord;
+    }
+)";
+
+static const char* backgroundFragmentShaderSource = R"(
+    #version 330 core
+    out vec4 FragColor;
+    in vec2 TexCoord;
+    uniform sampler2D backgroundTexture;
+    void main() {
+        FragColor = texture(backgroundTexture, TexCoord);
+    }
+)";
+
+// Overlay de líneas 2D (contorno del marcador) en coordenadas NDC.
+static const char* overlayVertexShaderSource = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec3 aColor;
+    out vec3 Color;
+    void main() {
+        gl_Position = vec4(aPos, 0.0, 1.0);
+        Color = aColor;
+    }
+)";
+
+static const char* overlayFragmentShaderSource = R"(
+    #version 330 core
+    out vec4 FragColor;
+    in vec3 Color;
+    void main() {
+        FragColor = vec4(Color, 1.0);
+    }
+)";
+
+// Reescalado del pase del modelo a resolución completa. Cada píxel combina los
+// 4 texels vecinos con pesos bilineales, atenuando los que tienen una cobertura
+// (alfa) distinta al texel más cercano para no difuminar la silueta.
+static const char* upscaleFragmentShaderSource = R"(
+    #version 330 core
+    out vec4 FragColor;
+    in vec2 TexCoord;
+    uniform sampler2D lowResTexture;
+    uniform vec2 lowResSize;
+    void main() {
+        vec2 p = TexCoord * lowResSize - 0.5;
+        vec2 f = fract(p);
+        ivec2 base = ivec2(floor(p));
+        ivec2 maxTexel = ivec2(lowResSize) - 1;
+
+        vec4 taps[4];
+        taps[0] = texelFetch(lowResTexture, clamp(base, ivec2(0), maxTexel), 0);
+        taps[1] = texelFetch(lowResTexture, clamp(base + ivec2(1, 0), ivec2(0), maxTexel), 0);
+        taps[2] = texelFetch(lowResTexture, clamp(base + ivec2(0, 1), ivec2(0), maxTexel), 0);
+        taps[3] = texelFetch(lowResTexture, clamp(base + ivec2(1, 1), ivec2(0), maxTexel), 0);
+        float weights[4] = float[4]((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+
+        int nearest = 0;
+        for (int i = 1; i < 4; ++i) {
+            if (weights[i] > weights[nearest]) nearest = i;
+        }
+
+        vec4 color = vec4(0.0);
+        float total = 0.0;
+        for (int i = 0; i < 4; ++i) {
+            float w = weights[i] * (1.0 - abs(taps[i].a - taps[nearest].a)) + 1e-4;
+            color += w * taps[i];
+            total += w;
+        }
+        // El pase del modelo limpia a alfa 0, así que el color ya está premultiplicado.
+        FragColor = color / total;
+    }
+)";
+
+bool parseObjModel(const std::string& objPath, const std::string& mtlBasePath, const TextureCache& textureCache,
+                   ModelData& data, bool compressTextures) {
+    auto parseStart = std::chrono::steady_clock::now();
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objPath.c_str(), mtlBasePath.c_str())) {
+        std::cerr << "Error al cargar el modelo OBJ: " << warn << err << std::endl;
+        return false;
+    }
+    if (!warn.empty()) {
+        std::cout << "Advertencia de TinyObjLoader: " << warn << std::endl;
+    }
+
+    data.objPath = objPath;
+    std::vector<float>& vertices = data.vertices;
+    vertices.clear();
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    for (const auto& shape : shapes) {
+        for (const auto& index : shape.mesh.indices) {
+            const glm::vec3 position(attrib.vertices[3 * index.vertex_index + 0],
+                                     attrib.vertices[3 * index.vertex_index + 1],
+                                     attrib.vertices[3 * index.vertex_index + 2]);
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+            vertices.push_back(position.x);
+            vertices.push_back(position.y);
+            vertices.push_back(position.z);
+
+            if (index.normal_index >= 0) {
+                vertices.push_back(attrib.normals[3 * index.normal_index + 0]);
+                vertices.push_back(attrib.normals[3 * index.normal_index + 1]);
+                vertices.push_back(attrib.normals[3 * index.normal_index + 2]);
+            } else {
+                vertices.push_back(0.0f);
+                vertices.push_back(0.0f);
+                vertices.push_back(0.0f);
+            }
+
+            if (index.texcoord_index >= 0) {
+                vertices.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
+                vertices.push_back(attrib.texcoords[2 * index.texcoord_index + 1]);
+            } else {
+                vertices.push_back(0.0f);
+                vertices.push_back(0.0f);
+            }
+        }
+    }
+    
+    if (!materials.empty()) {
+        data.diffuseColor = glm::vec3(materials[0].diffuse[0], materials[0].diffuse[1], materials[0].diffuse[2]);
+        if (!materials[0].diffuse_texname.empty()) {
+            data.hasTexture = textureCache.prepare(mtlBasePath + materials[0].diffuse_texname,
+                                                   compressTextures, data.texture);
+        }
+    }
+
+    data.boundsMin = boundsMin;
+    data.boundsMax = boundsMax;
+    data.staging.set((attrib.vertices.size() + attrib.normals.size() + attrib.texcoords.size()) * sizeof(float)
+                     + vertices.size() * sizeof(float));
+    data.parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - parseStart).count();
+    return true;
+}
+
+// vertices == nullptr reserva el buffer sin datos (se rellena después con glBufferSubData).
+void createModelBuffers(Model& model, size_t bytes, const float* vertices) {
+    createVertexBuffer(model, bytes, vertices);
+    attachVertexArray(model);
+}
+
+void createVertexBuffer(Model& model, size_t bytes, const float* vertices) {
+    glGenBuffers(1, &model.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, model.vbo);
+    glBufferData(GL_ARRAY_BUFFER, bytes, vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    ResourceTracker::instance().trackGLObject(false, model.vbo, ResourceCategory::GpuVertexBuffers, bytes);
+}
+
+void attachVertexArray(Model& model) {
+    glGenVertexArrays(1, &model.vao);
+    glBindVertexArray(model.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, model.vbo);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+size_t uploadModelResources(ModelData& data, TextureCache& textureCache, Model& model) {
+    model.diffuseColor = data.diffuseColor;
+    model.boundsMin = data.boundsMin;
+    model.boundsMax = data.boundsMax;
+    model.vertexCount = (int)(data.vertices.size() / 8);
+    const size_t vertexBytes = data.vertices.size() * sizeof(float);
+    createVertexBuffer(model, vertexBytes, data.vertices.data());
+    size_t gpuBytes = vertexBytes;
+    if (data.hasTexture) {
+        TextureLoadInfo info;
+        model.diffuseTexture = textureCache.upload(data.texture, &info);
+        ResourceTracker::instance().trackGLObject(true, model.diffuseTexture, ResourceCategory::GpuTextures,
+                                                  info.gpuBytes);
+        gpuBytes += info.gpuBytes;
+    }
+    return gpuBytes;
+}
+
+void releaseModelBuffers(Model& model) {
+    ResourceTracker& tracker = ResourceTracker::instance();
+    tracker.untrackGLObject(false, model.vbo);
+    tracker.untrackGLObject(true, model.diffuseTexture);
+    glDeleteVertexArrays(1, &model.vao);
+    glDeleteBuffers(1, &model.vbo);
+    glDeleteTextures(1, &model.diffuseTexture);
+    model = Model();
+}
+
+template <typename ObjectPolicy>
+ARRenderer<ObjectPolicy>::ARRenderer()
+    : objectShaders("del modelo", objectVertexShaderBody, objectFragmentShaderBody,
+                    {"DIFFUSE_TEXTURE", "DIFFUSE_COLOR", "UNIFORM_SCALE"},
+                    {"projection", "view", "model", "objectColor", "lightColor", "lightPos", "viewPos", "useTexture",
+                     "diffuseTexture"}) {
+    // El ancla es el sistema del marcador (la vista se pasa aparte al shader),
+    // el objeto lleva la animación y la submalla la orientación y escala del OBJ.
+    anchorNode = sceneGraph.addNode();
+    objectNode = sceneGraph.addNode(anchorNode);
+    submeshNode = sceneGraph.addNode(objectNode, ObjectPolicy::baseTransform());
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::init(int width, int height, const std::string& title, bool visible) {
+    if (!glfwInit()) {
+        std::cerr << "Error: No se pudo inicializar GLFW." << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+
+    window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Error: No se pudo crear la ventana de GLFW." << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetWindowUserPointer(window, this);
+    int initialWidth = 0, initialHeight = 0;
+    glfwGetFramebufferSize(window, &initialWidth, &initialHeight);
+    fbWidth = initialWidth;
+    fbHeight = initialHeight;
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow* window, int w, int h) {
+        glViewport(0, 0, w, h);
+        static_cast<ARRenderer*>(glfwGetWindowUserPointer(window))->onFramebufferResize(w, h);
+    });
+    // La ventana pide repintarse (p. ej. al dejar de estar tapada).
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow* window) {
+        static_cast<ARRenderer*>(glfwGetWindowUserPointer(window))->windowDamaged = true;
+    });
+    glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int, int action, int) {
+        if (action == GLFW_PRESS) static_cast<ARRenderer*>(glfwGetWindowUserPointer(window))->pressedKeys.push_back(key);
+    });
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Error: No se pudo inicializar GLAD." << std::endl;
+        glfwDestroyWindow(window);
+        window = nullptr;
+        glfwTerminate();
+        return false;
+    }
+    // Intervalo de intercambio explícito desde el principio, no el que traiga el driver.
+    pacer.configure(pacer.getOptions());
+
+    const bool objectShaderReady = objectShaders.init();
+    backgroundShaderProgram = createShaderProgram(backgroundVertexShaderSource, backgroundFragmentShaderSource);
+    upscaleShaderProgram = createShaderProgram(backgroundVertexShaderSource, upscaleFragmentShaderSource);
+    overlayShaderProgram = createShaderProgram(overlayVertexShaderSource, overlayFragmentShaderSource);
+    
+    if (!objectShaderReady || backgroundShaderProgram == 0 || upscaleShaderProgram == 0 ||
+        overlayShaderProgram == 0) return false;
+    // Con compilación paralela las variantes se piden ya y avanzan mientras se abre
+    // la cámara; si no, esperan al hilo de subidas o al primer fotograma.
+    if (objectShaders.parallelCompile()) requestObjectShaderVariants();
+
+    setupBackground();
+    setupOverlay();
+    glGenQueries(2, timeQueries);
+    glGenQueries(2, sampleQueries);
+
+    glEnable(GL_DEPTH_TEST);
+    
+    glGenTextures(1, &backgroundTexture);
+    glBindTexture(GL_TEXTURE_2D, backgroundTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    depthDirtyRect = fullFramebufferRect();
+    return true;
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::loadModel(const std::string& objPath, const std::string& mtlBasePath) {
+    ModelData data;
+    if (!parseModel(objPath, mtlBasePath, data, TextureCache::s3tcSupported())) return false;
+    return uploadModel(data);
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::parseModel(const std::string& objPath, const std::string& mtlBasePath, ModelData& data,
+                                          bool compressTextures) const {
+    return parseObjModel(objPath, mtlBasePath, textureCache, data, compressTextures);
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::uploadModel(ModelData& data) {
+    auto uploadStart = std::chrono::steady_clock::now();
+    const std::vector<float>& vertices = data.vertices;
+    Model& model = models[activeModel.load(std::memory_order_relaxed)];
+    model.diffuseColor = data.diffuseColor;
+
+    if (data.hasTexture) {
+        TextureLoadInfo info;
+        model.diffuseTexture = textureCache.upload(data.texture, &info);
+        ResourceTracker::instance().trackGLObject(true, model.diffuseTexture, ResourceCategory::GpuTextures, info.gpuBytes);
+        stats.textureGpuBytes += info.gpuBytes;
+        stats.textureRawBytes += info.rawBytes;
+        stats.textureLoadMs += info.loadMs;
+        stats.texturesFromCache = info.fromCache;
+    }
+
+    model.vertexCount = vertices.size() / 8;
+    model.boundsMin = data.boundsMin;
+    model.boundsMax = data.boundsMax;
+    createModelBuffers(model, vertices.size() * sizeof(float), vertices.data());
+
+    stats.vertexBytes = vertices.size() * sizeof(float);
+    stats.modelLoadMs = data.parseMs +
+                        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+
+    std::cout << "Modelo cargado exitosamente: " << data.objPath << std::endl;
+    std::cout << "Vértices procesados: " << model.vertexCount << std::endl;
+    std::cout << "Memoria de GPU: " << (stats.vertexBytes / 1024) << " KB de vértices, "
+              << (stats.textureGpuBytes / 1024) << " KB de texturas (sin comprimir: "
+              << (stats.textureRawBytes / 1024) << " KB)" << std::endl;
+    std::cout << "Tiempo de carga: " << stats.modelLoadMs << " ms (texturas: "
+              << stats.textureLoadMs << " ms" << (stats.texturesFromCache ? ", desde caché" : "") << ")" << std::endl;
+
+    // Ya vive en la GPU: se libera la copia de CPU.
+    std::vector<float>().swap(data.vertices);
+    data.texture = TextureCache::PreparedTexture();
+    data.staging.set(0);
+    return true;
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::requestModelSwap(const std::string& objPath, const std::string& mtlBasePath) {
+    if (swapState != SwapState::Idle) return false;
+    swapStart = std::chrono::steady_clock::now();
+    swapData = std::make_unique<ModelData>();
+    ModelData* data = swapData.get();
+    // Se consulta aquí, con el contexto activo: el hilo del parseo no tiene contexto.
+    const bool compressTextures = TextureCache::s3tcSupported();
+    swapParsed = std::async(std::launch::async, [this, objPath, mtlBasePath, data, compressTextures] {
+        return parseModel(objPath, mtlBasePath, *data, compressTextures);
+    });
+    swapState = SwapState::Parsing;
+    std::cout << "Cambiando al modelo " << objPath << "..." << std::endl;
+    return true;
+}
+
+// Avanza el cambio en caliente al inicio de cada fotograma (hilo de GL). Ningún paso
+// bloquea: se espera al parseo, se suben swapUploadBudget bytes por fotograma y la
+// textura en uno, y el cambio es un store atómico del índice del modelo activo.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::pumpModelSwap(const RenderCommandList& list) {
+    const int active = activeModel.load(std::memory_order_relaxed);
+
+    // Retiro del modelo anterior: cuando llega la primera lista grabada con el modelo
+    // nuevo ya no quedan listas por ejecutar que usen el viejo; el fence marca el final
+    // de los comandos ya enviados que sí lo usaban.
+    if (retiringModel >= 0) {
+        if (!retireFence && list.modelGeneration == models[active].generation) {
+            retireFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        } else if (retireFence) {
+            const GLenum status = glClientWaitSync(retireFence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                glDeleteSync(retireFence);
+                retireFence = nullptr;
+                releaseModelBuffers(models[retiringModel]);
+                retiringModel = -1;
+            }
+        }
+    }
+
+    if (swapState == SwapState::Parsing) {
+        if (swapParsed.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+        if (!swapParsed.get()) {
+            std::cerr << "Error: No se pudo cargar el modelo nuevo; se mantiene el actual." << std::endl;
+            swapData.reset();
+            swapState = SwapState::Idle;
+            return;
+        }
+        swapUploadedBytes = 0;
+        swapUploadFrames = 0;
+        swapState = SwapState::Uploading;
+    }
+    // El segundo juego de buffers sigue ocupado hasta que se retire el modelo anterior.
+    if (swapState != SwapState::Uploading || retiringModel >= 0) return;
+
+    ModelData& data = *swapData;
+    Model& target = models[1 - active];
+    const size_t totalBytes = data.vertices.size() * sizeof(float);
+    swapUploadFrames++;
+
+    // Con hilo de subidas todo se sube de una vez fuera de este hilo; aquí solo se
+    // espera su fence y se arma el VAO. target no se toca hasta entonces.
+    if (uploader.running()) {
+        if (swapTicket == 0) {
+            ModelData* pending = swapData.get();
+            swapTicket = uploader.submit([this, pending, &target] { uploadModelResources(*pending, textureCache, target); },
+                                         totalBytes);
+            return;
+        }
+        if (!uploader.poll(swapTicket)) return;
+        swapTicket = 0;
+        attachVertexArray(target);
+        activateSwappedModel(active, totalBytes);
+        return;
+    }
+
+    if (target.vao == 0) createModelBuffers(target, totalBytes, nullptr);
+
+    if (swapUploadedBytes < totalBytes) {
+        const size_t chunk = std::min(swapUploadBudget, totalBytes - swapUploadedBytes);
+        glBindBuffer(GL_ARRAY_BUFFER, target.vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, swapUploadedBytes, chunk, (const char*)data.vertices.data() + swapUploadedBytes);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        swapUploadedBytes += chunk;
+        return;
+    }
+
+    if (data.hasTexture && target.diffuseTexture == 0) {
+        TextureLoadInfo info;
+        target.diffuseTexture = textureCache.upload(data.texture, &info);
+        ResourceTracker::instance().trackGLObject(true, target.diffuseTexture, ResourceCategory::GpuTextures, info.gpuBytes);
+        return;
+    }
+
+    target.vertexCount = data.vertices.size() / 8;
+    target.diffuseColor = data.diffuseColor;
+    target.boundsMin = data.boundsMin;
+    target.boundsMax = data.boundsMax;
+    activateSwappedModel(active, totalBytes);
+}
+
+// Último paso del cambio, con el modelo nuevo ya completo en models[1 - active].
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::activateSwappedModel(int active, size_t vertexBytes) {
+    Model& target = models[1 - active];
+    target.generation = models[active].generation + 1;
+    activeModel.store(1 - active, std::memory_order_release);
+    retiringModel = active;
+
+    stats.modelSwaps++;
+    stats.vertexBytes = vertexBytes;
+    stats.lastSwapMs = elapsedMs(swapStart);
+    stats.lastSwapUploadFrames = swapUploadFrames;
+    std::cout << "Modelo cambiado: " << swapData->objPath << " (" << target.vertexCount << " vértices, "
+              << stats.lastSwapMs << " ms, subida en " << swapUploadFrames << " fotogramas)" << std::endl;
+    swapData.reset();
+    swapState = SwapState::Idle;
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::consumeKeyPress(int key) {
+    auto it = std::find(pressedKeys.begin(), pressedKeys.end(), key);
+    if (it == pressedKeys.end()) return false;
+    pressedKeys.erase(it);
+    return true;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::buildCommands(RenderCommandList& list, cv::Size frameSize, const cv::Vec3d& rvec,
+                                             const cv::Vec3d& tvec, const cv::Mat& cameraMatrix) {
+    auto buildStart = std::chrono::steady_clock::now();
+    beginRecording(list);
+
+    // El hilo de GL solo cambia el índice activo después de subir el otro modelo
+    // completo, y no toca el que se lee aquí hasta haber ejecutado una lista posterior.
+    const Model& model = models[activeModel.load(std::memory_order_acquire)];
+    list.modelGeneration = model.generation;
+    if (model.vao != 0 && ObjectPolicy::visible(tvec)) {
+        const ModelTransforms transforms = computeModelTransforms(frameSize, rvec, tvec, cameraMatrix);
+        setModelRect(list, projectedModelRect(model, transforms) & fullFramebufferRect());
+        recordModel(list, model, transforms);
+    }
+    list.animating = ObjectPolicy::animated && animationActive;
+    list.buildMs = elapsedMs(buildStart);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::buildCommands(RenderCommandList& list, cv::Size frameSize,
+                                             const std::vector<MarkerPose>& poses, const cv::Mat& cameraMatrix) {
+    auto buildStart = std::chrono::steady_clock::now();
+    beginRecording(list);
+    list.modelGeneration = models[activeModel.load(std::memory_order_acquire)].generation;
+
+    cv::Rect modelRect;
+    for (const MarkerPose& pose : poses) {
+        Model model;
+        uint32_t ref = 0;
+        if (!assets || !ObjectPolicy::visible(pose.tvec) || !assets->acquire(pose.id, model, ref)) continue;
+        list.assetRefs.push_back(ref);
+        const ModelTransforms transforms = computeModelTransforms(frameSize, pose.rvec, pose.tvec, cameraMatrix);
+        modelRect = modelRect | (projectedModelRect(model, transforms) & fullFramebufferRect());
+        recordModel(list, model, transforms);
+    }
+    if (!list.assetRefs.empty()) setModelRect(list, modelRect);
+    list.animating = ObjectPolicy::animated && animationActive;
+    list.buildMs = elapsedMs(buildStart);
+}
+
+// Una lista descartada sin ejecutar (el último gana) aún tiene sus referencias.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::beginRecording(RenderCommandList& list) {
+    if (assets) assets->release(list.assetRefs);
+    list.reset();
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::setModelRect(RenderCommandList& list, const cv::Rect& rect) {
+    list.modelVisible = true;
+    list.modelRect[0] = rect.x;
+    list.modelRect[1] = rect.y;
+    list.modelRect[2] = rect.width;
+    list.modelRect[3] = rect.height;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::addMarkerOverlay(RenderCommandList& list, const std::vector<cv::Point2f>& corners, cv::Size frameSize) const {
+    static const float color[3] = {0.0f, 1.0f, 0.0f};
+    for (size_t i = 0; i < corners.size(); ++i) {
+        const cv::Point2f& a = corners[i];
+        const cv::Point2f& b = corners[(i + 1) % corners.size()];
+        list.overlayLine(a.x / frameSize.width * 2.0f - 1.0f, 1.0f - a.y / frameSize.height * 2.0f,
+                         b.x / frameSize.width * 2.0f - 1.0f, 1.0f - b.y / frameSize.height * 2.0f, color);
+    }
+}
+
+enum DamageFlags : unsigned {
+    DamageBackground = 1u << 0,
+    DamageCommands = 1u << 1,
+    DamageAnimation = 1u << 2,
+    DamageWindow = 1u << 3
+};
+
+// Tamaño de la miniatura con la que se compara el fondo: promediar bloques grandes
+// quita casi todo el ruido del sensor sin perder un movimiento real.
+static const cv::Size damageThumbnailSize(40, 30);
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::setDamageTracking(bool enabled, float backgroundThreshold, float commandEpsilon) {
+    damageTracking = enabled;
+    damageBackgroundThreshold = backgroundThreshold;
+    damageCommandEpsilon = commandEpsilon;
+    lastDrawnThumbnail.release();
+    windowDamaged = true;
+}
+
+template <typename ObjectPolicy>
+unsigned ARRenderer<ObjectPolicy>::computeDamage(const cv::Mat& frame, const RenderCommandList& list,
+                                                 cv::Mat& thumbnail) {
+    unsigned damage = 0;
+    if (windowDamaged.exchange(false)) damage |= DamageWindow;
+    if (list.animating) damage |= DamageAnimation;
+
+    cv::Mat small;
+    cv::resize(frame, small, damageThumbnailSize, 0, 0, cv::INTER_AREA);
+    if (small.channels() == 3)
+        cv::cvtColor(small, thumbnail, cv::COLOR_BGR2GRAY);
+    else
+        thumbnail = small;
+    if (lastDrawnThumbnail.empty() || lastDrawnThumbnail.size() != thumbnail.size()) {
+        damage |= DamageBackground;
+    } else {
+        cv::Mat difference;
+        cv::absdiff(thumbnail, lastDrawnThumbnail, difference);
+        if (cv::mean(difference)[0] > damageBackgroundThreshold) damage |= DamageBackground;
+    }
+
+    if (!list.sameAs(lastDrawnCommands, damageCommandEpsilon)) damage |= DamageCommands;
+    return damage;
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::execute(const cv::Mat& frame, RenderCommandList& list) {
+    auto executeStart = std::chrono::steady_clock::now();
+    pumpModelSwap(list);
+    requestObjectShaderVariants();
+    objectShaders.poll();
+
+    // Se compara siempre con el último fotograma dibujado, no con el anterior: un
+    // cambio lento acaba superando el umbral.
+    cv::Mat thumbnail;
+    if (damageTracking) {
+        const unsigned damage = computeDamage(frame, list, thumbnail);
+        if (damage == 0) {
+            stats.damage.skipped++;
+            if (assets) {
+                assets->release(list.assetRefs);
+                assets->pump();
+            }
+            return false;
+        }
+        stats.damage.drawn++;
+        if (damage & DamageBackground) stats.damage.background++;
+        if (damage & DamageCommands) stats.damage.commands++;
+        if (damage & DamageAnimation) stats.damage.animation++;
+        if (damage & DamageWindow) stats.damage.window++;
+    }
+
+    // El pase reducido compone el modelo con mezcla sobre el fondo, así que usa el orden clásico.
+    const CompositeMode mode = modelRenderScale < 1.0f ? CompositeMode::Legacy : compositeMode;
+    beginCompositeTiming(mode);
+
+    if (mode == CompositeMode::FillRate) {
+        renderFillRateOrder(frame, list);
+    } else {
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        currentClearedPixels = 2.0 * framebufferWidth() * framebufferHeight();
+
+        drawBackground(frame, 0.0f);
+
+        glClear(GL_DEPTH_BUFFER_BIT);
+        currentClearedPixels += (double)framebufferWidth() * framebufferHeight();
+        depthDirtyRect = fullFramebufferRect();
+
+        // --- 2. Dibujar el objeto 3D si se ha cargado un modelo y es visible ---
+        if (list.modelVisible) {
+            if (modelRenderScale < 1.0f) {
+                drawModelReducedResolution(list);
+            } else {
+                list.execute();
+            }
+        }
+    }
+    drawOverlay(list);
+
+    endCompositeTiming(mode);
+    if (damageTracking) {
+        lastDrawnThumbnail = thumbnail;
+        lastDrawnCommands = list;
+        lastDrawnCommands.assetRefs.clear();
+    }
+    // GL difiere el borrado real de un modelo desalojado mientras la GPU lo use.
+    if (assets) {
+        assets->release(list.assetRefs);
+        assets->pump();
+    }
+    buildTimes.add(list.buildMs);
+    executeTimes.add(elapsedMs(executeStart));
+    return true;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::render(const cv::Mat& frame, const cv::Vec3d& rvec, const cv::Vec3d& tvec, const cv::Mat& cameraMatrix) {
+    buildCommands(frameCommands, frame.size(), rvec, tvec, cameraMatrix);
+    execute(frame, frameCommands);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::setCompositeMode(CompositeMode mode) {
+    compositeMode = mode;
+    depthDirtyRect = fullFramebufferRect();
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::printReport() const {
+    buildTimes.print("Grabación de comandos");
+    executeTimes.print("Ejecución de comandos (hilo GL)");
+
+    static const char* names[2] = {"clásico", "fill-rate"};
+    for (int i = 0; i < 2; ++i) {
+        const CompositeStats& c = stats.composite[i];
+        if (c.frames == 0) continue;
+        const double timed = (double)std::max(1LL, c.timedFrames);
+        std::cout << "Composición " << names[i] << ": " << c.frames << " fotogramas, "
+                  << (c.gpuMs / timed) << " ms de GPU, "
+                  << (long long)(c.samplesPassed / timed) << " fragmentos, "
+                  << (long long)(c.clearedPixels / c.frames) << " píxeles limpiados por fotograma" << std::endl;
+    }
+    if (stats.modelSwaps > 0)
+        std::cout << "Cambios de modelo en caliente: " << stats.modelSwaps << " (último: " << stats.lastSwapMs
+                  << " ms, " << stats.lastSwapUploadFrames << " fotogramas de subida)" << std::endl;
+    if (damageTracking) {
+        const DamageStats& d = stats.damage;
+        std::cout << "Redibujo por daño: " << d.drawn << " dibujados, " << d.skipped << " omitidos ("
+                  << 100.0 * d.skipped / std::max(1LL, d.drawn + d.skipped) << "%); motivos: fondo " << d.background
+                  << ", pose/overlay " << d.commands << ", animación " << d.animation << ", ventana " << d.window
+                  << std::endl;
+    }
+    if (stats.backgroundUploads > 0)
+        std::cout << "Fondo: " << backgroundWidth << "x" << backgroundHeight << ", "
+                  << stats.backgroundUploadBytes / stats.backgroundUploads / 1024 << " KB subidos por fotograma (de "
+                  << stats.backgroundFrameBytes / stats.backgroundUploads / 1024 << " KB de la cámara)" << std::endl;
+    backgroundPrepareTimes.print("Preparación del fondo (escala y volteo)");
+    objectShaders.printReport();
+    pacer.printReport();
+    uploader.printReport();
+    ResourceTracker::instance().printReport();
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::setModelRenderScale(float scale) {
+    modelRenderScale = std::min(1.0f, std::max(0.1f, scale));
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::setOffscreenOutput(bool enabled) {
+    renderToOffscreen = false;
+    if (enabled && !outputTarget.resize(framebufferWidth(), framebufferHeight())) return false;
+    renderToOffscreen = enabled;
+    bindOutputFramebuffer();
+    depthDirtyRect = fullFramebufferRect();
+    return true;
+}
+
+template <typename ObjectPolicy>
+cv::Mat ARRenderer<ObjectPolicy>::readOutput() const {
+    cv::Mat image(framebufferHeight(), framebufferWidth(), CV_8UC3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, image.cols, image.rows, GL_BGR, GL_UNSIGNED_BYTE, image.data);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    cv::flip(image, image, 0);
+    return image;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::resizeWindow(int width, int height) {
+    int currentWidth = 0, currentHeight = 0;
+    glfwGetWindowSize(window, &currentWidth, &currentHeight);
+    if (width > 0 && height > 0 && (width != currentWidth || height != currentHeight))
+        glfwSetWindowSize(window, width, height);
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::windowShouldClose() {
+    return glfwWindowShouldClose(window);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::pollEventsAndSwapBuffers() {
+    pacer.beforeSwap();
+    glfwSwapBuffers(window);
+    pacer.afterSwap();
+    pressedKeys.clear();
+    glfwPollEvents();
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::pollEvents() {
+    pacer.frameSkipped();
+    pressedKeys.clear();
+    glfwPollEvents();
+}
+
+template <typename ObjectPolicy>
+const RendererStats& ARRenderer<ObjectPolicy>::getStats() {
+    for (int c = 0; c < (int)ResourceCategory::Count; ++c)
+        stats.memory[c] = ResourceTracker::instance().stats((ResourceCategory)c);
+    return stats;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::triggerAnimation() {
+    if constexpr (ObjectPolicy::animated) {
+        if (!animationActive) {
+            animationActive = true;
+            animationStartTime = glfwGetTime();
+        }
+    }
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::cleanup() {
+    if (swapParsed.valid()) swapParsed.wait();
+    // Sin ventana no hay contexto ni punteros de glad (--headless, init fallido o
+    // cleanup ya llamado): no hay nada de GL que liberar.
+    if (!window) return;
+    // Antes de borrar los modelos: un cambio en curso puede estar subiendo a models[].
+    uploader.stop();
+    swapTicket = 0;
+    if (retireFence) glDeleteSync(retireFence);
+    retireFence = nullptr;
+    retiringModel = -1;
+    releaseModelBuffers(models[0]);
+    releaseModelBuffers(models[1]);
+
+    ResourceTracker& tracker = ResourceTracker::instance();
+    tracker.untrackGLObject(false, backgroundVBO);
+    tracker.untrackGLObject(false, overlayVBO);
+    tracker.untrackGLObject(true, backgroundTexture);
+
+    objectShaders.destroy();
+    objectShaderVariantsRequested = false;
+    pacer.release();
+    glDeleteVertexArrays(1, &backgroundVAO);
+    glDeleteBuffers(1, &backgroundVBO);
+    glDeleteProgram(backgroundShaderProgram);
+    glDeleteProgram(upscaleShaderProgram);
+    glDeleteProgram(overlayShaderProgram);
+    glDeleteVertexArrays(1, &overlayVAO);
+    glDeleteBuffers(1, &overlayVBO);
+    glDeleteTextures(1, &backgroundTexture);
+    modelTarget.destroy();
+    outputTarget.destroy();
+    glDeleteQueries(2, timeQueries);
+    glDeleteQueries(2, sampleQueries);
+
+    glfwDestroyWindow(window);
+    window = nullptr;
+    glfwTerminate();
+}
+
+// Solo toca el grafo cuando la animación cambia la local del objeto.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::updateAnimationNode() {
+    if constexpr (ObjectPolicy::animated) {
+        glm::mat4 local(1.0f);
+        if (animationActive && !ObjectPolicy::animate((float)glfwGetTime() - animationStartTime, local))
+            animationActive = false;
+        if (animationActive) {
+            sceneGraph.setLocal(objectNode, local);
+            animationApplied = true;
+        } else if (animationApplied) {
+            sceneGraph.setLocal(objectNode, glm::mat4(1.0f));
+            animationApplied = false;
+        }
+    }
+    sceneGraph.update();
+}
+
+template <typename ObjectPolicy>
+typename ARRenderer<ObjectPolicy>::ModelTransforms ARRenderer<ObjectPolicy>::computeModelTransforms(
+    cv::Size frameSize, const cv::Vec3d& rvec, const cv::Vec3d& tvec, const cv::Mat& cameraMatrix) {
+    ModelTransforms t;
+    t.projection = buildProjectionMatrix(cameraMatrix, frameSize.width, frameSize.height, 0.1f, 100.0f);
+    t.view = buildViewMatrix(rvec, tvec);
+
+    updateAnimationNode();
+    t.model = sceneGraph.world(submeshNode);
+    return t;
+}
+
+template <typename ObjectPolicy>
+bool ARRenderer<ObjectPolicy>::startUploadThread() {
+    if (!uploader.start(window)) return false;
+    requestObjectShaderVariants();
+    return true;
+}
+
+// Las dos variantes que usa recordModel: el color del material fijado en
+// compilación y normales sin inverse(), válidas porque las políticas solo escalan
+// de forma uniforme.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::requestObjectShaderVariants() {
+    if (objectShaderVariantsRequested) return;
+    objectShaderVariantsRequested = true;
+    GpuUploader* worker = getUploader();
+    objectShaders.request(ShaderDiffuseTexture | ShaderUniformScale, worker);
+    objectShaders.request(ShaderDiffuseColor | ShaderUniformScale, worker);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::recordModel(RenderCommandList& list, const Model& model, const ModelTransforms& t) const {
+    // La variante especializada si ya compiló; si no, la básica. Las ubicaciones
+    // de uniformes que una variante no usa son -1 y GL ignora esos comandos.
+    const uint32_t features = (model.diffuseTexture != 0 ? ShaderDiffuseTexture : ShaderDiffuseColor) |
+                              ShaderUniformScale;
+    const ShaderPermutations::Variant& shader = objectShaders.select(features);
+    const std::vector<GLint>& u = shader.uniforms;
+    list.useProgram(shader.program);
+
+    list.uniformMat4(u[ObjectUniformProjection], glm::value_ptr(t.projection));
+    list.uniformMat4(u[ObjectUniformView], glm::value_ptr(t.view));
+    list.uniformMat4(u[ObjectUniformModel], glm::value_ptr(t.model));
+
+    list.uniformVec3(u[ObjectUniformObjectColor], glm::value_ptr(model.diffuseColor));
+    list.uniformVec3(u[ObjectUniformLightColor], 1.0f, 1.0f, 1.0f);
+    list.uniformVec3(u[ObjectUniformLightPos], 0.5f, 0.5f, -0.5f);
+    list.uniformVec3(u[ObjectUniformViewPos], 0.0f, 0.0f, 0.0f);
+
+    list.uniformInt(u[ObjectUniformUseTexture], model.diffuseTexture != 0);
+    if (model.diffuseTexture != 0) {
+        list.bindTexture(1, model.diffuseTexture);
+        list.uniformInt(u[ObjectUniformDiffuseTexture], 1);
+    }
+
+    list.drawArrays(model.vao, 0, model.vertexCount);
+}
+
+// Dibuja el modelo en un FBO reducido y lo compone sobre el fondo a resolución completa.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::drawModelReducedResolution(const RenderCommandList& list) {
+    const int lowWidth = std::max(1, (int)(framebufferWidth() * modelRenderScale));
+    const int lowHeight = std::max(1, (int)(framebufferHeight() * modelRenderScale));
+    if (!modelTarget.resize(lowWidth, lowHeight)) {
+        list.execute();
+        return;
+    }
+
+    modelTarget.bind();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    list.execute();
+    bindOutputFramebuffer();
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(upscaleShaderProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, modelTarget.colorTexture);
+    glUniform1i(glGetUniformLocation(upscaleShaderProgram, "lowResTexture"), 0);
+    glUniform2f(glGetUniformLocation(upscaleShaderProgram, "lowResSize"), (float)lowWidth, (float)lowHeight);
+
+    glBindVertexArray(backgroundVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+// Modelo primero y fondo después en el plano lejano: los píxeles tapados por el
+// modelo no se sombrean dos veces. El color no se limpia (el fondo cubre toda la
+// ventana). En el FBO propio la profundidad se conserva entre fotogramas y solo se
+// limpia donde el modelo la escribió; la de la ventana queda indefinida tras
+// glfwSwapBuffers (GLX/EGL no garantizan conservarla), así que se limpia entera.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::renderFillRateOrder(const cv::Mat& frame, const RenderCommandList& list) {
+    const cv::Rect fullRect = fullFramebufferRect();
+    const cv::Rect modelRect = list.modelVisible
+        ? cv::Rect(list.modelRect[0], list.modelRect[1], list.modelRect[2], list.modelRect[3]) & fullRect
+        : cv::Rect();
+    const cv::Rect clearRect = renderToOffscreen ? (depthDirtyRect | modelRect) & fullRect : fullRect;
+
+    glEnable(GL_SCISSOR_TEST);
+    if (clearRect.area() > 0) {
+        glScissor(clearRect.x, clearRect.y, clearRect.width, clearRect.height);
+        glDepthMask(GL_TRUE);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        currentClearedPixels = clearRect.area();
+    }
+
+    if (modelRect.area() > 0) {
+        glScissor(modelRect.x, modelRect.y, modelRect.width, modelRect.height);
+        list.execute();
+    }
+    glDisable(GL_SCISSOR_TEST);
+    depthDirtyRect = modelRect;
+
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    drawBackground(frame, 1.0f);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+}
+
+// Rectángulo en píxeles de la ventana que cubre la caja envolvente proyectada.
+template <typename ObjectPolicy>
+cv::Rect ARRenderer<ObjectPolicy>::projectedModelRect(const Model& model, const ModelTransforms& t) const {
+    const glm::mat4 mvp = t.projection * t.view * t.model;
+    const int width = framebufferWidth(), height = framebufferHeight();
+    float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest(), maxY = std::numeric_limits<float>::lowest();
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec4 p = mvp * glm::vec4((corner & 1) ? model.boundsMax.x : model.boundsMin.x,
+                                            (corner & 2) ? model.boundsMax.y : model.boundsMin.y,
+                                            (corner & 4) ? model.boundsMax.z : model.boundsMin.z, 1.0f);
+        // Una esquina detrás de la cámara hace que la proyección no sea acotable.
+        if (p.w <= 1e-6f) return fullFramebufferRect();
+        minX = std::min(minX, p.x / p.w);
+        maxX = std::max(maxX, p.x / p.w);
+        minY = std::min(minY, p.y / p.w);
+        maxY = std::max(maxY, p.y / p.w);
+    }
+    const int x0 = (int)std::floor((minX * 0.5f + 0.5f) * width) - 2;
+    const int y0 = (int)std::floor((minY * 0.5f + 0.5f) * height) - 2;
+    const int x1 = (int)std::ceil((maxX * 0.5f + 0.5f) * width) + 2;
+    const int y1 = (int)std::ceil((maxY * 0.5f + 0.5f) * height) + 2;
+    if (x1 <= x0 || y1 <= y0) return cv::Rect();
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::bindOutputFramebuffer() {
+    glBindFramebuffer(GL_FRAMEBUFFER, renderToOffscreen ? outputTarget.fbo : 0);
+    glViewport(0, 0, framebufferWidth(), framebufferHeight());
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::onFramebufferResize(int w, int h) {
+    fbWidth = w;
+    fbHeight = h;
+    if (renderToOffscreen) outputTarget.resize(w, h);
+    // El contenido del framebuffer queda indefinido tras cambiar de tamaño.
+    depthDirtyRect = fullFramebufferRect();
+    windowDamaged = true;
+}
+
+// Las consultas se leen dos fotogramas después para no bloquear la CPU.
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::beginCompositeTiming(CompositeMode mode) {
+    const int slot = (int)(queryFrame & 1);
+    if (queryPending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(timeQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 elapsedNs = 0, samples = 0;
+            glGetQueryObjectui64v(timeQueries[slot], GL_QUERY_RESULT, &elapsedNs);
+            glGetQueryObjectui64v(sampleQueries[slot], GL_QUERY_RESULT, &samples);
+            CompositeStats& c = stats.composite[(int)queryMode[slot]];
+            c.gpuMs += elapsedNs / 1e6;
+            c.samplesPassed += (double)samples;
+            c.timedFrames++;
+        }
+        queryPending[slot] = false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, timeQueries[slot]);
+    glBeginQuery(GL_SAMPLES_PASSED, sampleQueries[slot]);
+    queryMode[slot] = mode;
+    currentClearedPixels = 0.0;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::endCompositeTiming(CompositeMode mode) {
+    const int slot = (int)(queryFrame & 1);
+    glEndQuery(GL_SAMPLES_PASSED);
+    glEndQuery(GL_TIME_ELAPSED);
+    queryPending[slot] = true;
+    queryFrame++;
+
+    CompositeStats& c = stats.composite[(int)mode];
+    c.frames++;
+    c.clearedPixels += currentClearedPixels;
+}
+
+template <typename ObjectPolicy>
+GLuint ARRenderer<ObjectPolicy>::createShaderProgram(const char* vsSource, const char* fsSource) {
+    return ShaderPermutations::buildProgram(vsSource, fsSource, "");
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::setupBackground() {
+    float quadVertices[] = { 
+        -1.0f,  1.0f,  0.0f, 1.0f,
+        -1.0f, -1.0f,  0.0f, 0.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+
+        -1.0f,  1.0f,  0.0f, 1.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+         1.0f,  1.0f,  1.0f, 1.0f
+    };
+    glGenVertexArrays(1, &backgroundVAO);
+    glGenBuffers(1, &backgroundVBO);
+    glBindVertexArray(backgroundVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, backgroundVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+    ResourceTracker::instance().trackGLObject(false, backgroundVBO, ResourceCategory::GpuVertexBuffers, sizeof(quadVertices));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+}
+
+// Fondo listo para subir: reducido al tamaño del framebuffer si la ventana se
+// muestra más pequeña que la cámara (nunca se amplía) y volteado al origen de GL.
+// La visión sigue trabajando sobre el fotograma completo.
+template <typename ObjectPolicy>
+const cv::Mat& ARRenderer<ObjectPolicy>::prepareBackground(const cv::Mat& frame) {
+    const cv::Size target(std::min(frame.cols, std::max(1, framebufferWidth())),
+                          std::min(frame.rows, std::max(1, framebufferHeight())));
+    if (target == frame.size()) {
+        cv::flip(frame, backgroundScratch, 0);
+        return backgroundScratch;
+    }
+    // cv::resize usa SIMD en ambos casos; por debajo de la mitad el bilineal
+    // submuestrea y aparece aliasing, así que se promedia por áreas.
+    const bool large = target.width * 2 < frame.cols || target.height * 2 < frame.rows;
+    cv::resize(frame, backgroundResized, target, 0, 0, large ? cv::INTER_AREA : cv::INTER_LINEAR);
+    cv::flip(backgroundResized, backgroundScratch, 0);
+    return backgroundScratch;
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::drawBackground(const cv::Mat& frame, float depth) {
+    glUseProgram(backgroundShaderProgram);
+    glUniform1f(glGetUniformLocation(backgroundShaderProgram, "depth"), depth);
+    
+    const auto prepareStart = std::chrono::steady_clock::now();
+    const cv::Mat& flippedFrame = prepareBackground(frame);
+    backgroundPrepareTimes.add(elapsedMs(prepareStart));
+
+    glBindTexture(GL_TEXTURE_2D, backgroundTexture);
+    // Las filas BGR de un ancho cualquiera no tienen por qué estar alineadas a 4 bytes.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (flippedFrame.cols != backgroundWidth || flippedFrame.rows != backgroundHeight) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, flippedFrame.cols, flippedFrame.rows, 0, GL_BGR, GL_UNSIGNED_BYTE,
+                     flippedFrame.data);
+        backgroundWidth = flippedFrame.cols;
+        backgroundHeight = flippedFrame.rows;
+        // Los drivers suelen guardar GL_RGB con 4 bytes por texel.
+        ResourceTracker::instance().trackGLObject(true, backgroundTexture, ResourceCategory::GpuTextures,
+                                                  (size_t)backgroundWidth * backgroundHeight * 4);
+    } else {
+        // Mismo tamaño: se reescribe sin reasignar el almacenamiento.
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, flippedFrame.cols, flippedFrame.rows, GL_BGR, GL_UNSIGNED_BYTE,
+                        flippedFrame.data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    stats.backgroundUploads++;
+    stats.backgroundUploadBytes += (double)flippedFrame.total() * flippedFrame.elemSize();
+    stats.backgroundFrameBytes += (double)frame.total() * frame.elemSize();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, backgroundTexture);
+    glUniform1i(glGetUniformLocation(backgroundShaderProgram, "backgroundTexture"), 0);
+
+    glBindVertexArray(backgroundVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::setupOverlay() {
+    glGenVertexArrays(1, &overlayVAO);
+    glGenBuffers(1, &overlayVBO);
+    glBindVertexArray(overlayVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
+    glBindVertexArray(0);
+}
+
+template <typename ObjectPolicy>
+void ARRenderer<ObjectPolicy>::drawOverlay(const RenderCommandList& list) {
+    const std::vector<float>& vertices = list.overlay();
+    if (vertices.empty()) return;
+
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(overlayShaderProgram);
+    glBindVertexArray(overlayVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW);
+    if (vertices.size() * sizeof(float) != overlayBufferBytes) {
+        overlayBufferBytes = vertices.size() * sizeof(float);
+        ResourceTracker::instance().trackGLObject(false, overlayVBO, ResourceCategory::GpuVertexBuffers, overlayBufferBytes);
+    }
+    glDrawArrays(GL_LINES, 0, (GLsizei)(vertices.size() / 5));
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+template <typename ObjectPolicy>
+glm::mat4 ARRenderer<ObjectPolicy>::buildProjectionMatrix(const cv::Mat& cameraMatrix, int screen_width, int screen_height,
+                                                          float near, float far) {
+    float fx = cameraMatrix.at<double>(0, 0);
+    float fy = cameraMatrix.at<double>(1, 1);
+    float cx = cameraMatrix.at<double>(0, 2);
+    float cy = cameraMatrix.at<double>(1, 2);
+
+    glm::mat4 projection = glm::mat4(0.0f);
+    projection[0][0] = 2.0f * fx / screen_width;
+    projection[1][1] = 2.0f * fy / screen_height;
+    projection[2][0] = 1.0f - 2.0f * cx / screen_width;
+    projection[2][1] = 2.0f * cy / screen_height - 1.0f;
+    projection[2][2] = -(far + near) / (far - near);
+    projection[2][3] = -1.0f;
+    projection[3][2] = -2.0f * far * near / (far - near);
+    return projection;
+}
+
+template <typename ObjectPolicy>
+glm::mat4 ARRenderer<ObjectPolicy>::buildViewMatrix(const cv::Vec3d& rvec, const cv::Vec3d& tvec) {
+    cv::Mat rot_mat;
+    cv::Rodrigues(rvec, rot_mat);
+
+    glm::mat4 view_matrix = glm::mat4(1.0f);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            view_matrix[j][i] = rot_mat.at<double>(i, j);
+        }
+    }
+    view_matrix[3][0] = tvec[0];
+    view_matrix[3][1] = tvec[1];
+    view_matrix[3][2] = tvec[2];
+    
+    static const glm::mat4 cv_to_gl = glm::mat4(
+        1,  0,  0, 0,
+        0, -1,  0, 0,
+        0,  0, -1, 0,
+        0,  0,  0, 1
+    );
+    
+    return cv_to_gl * view_matrix;
+}
+
+template class ARRenderer<AnimatedModelPolicy>;
+template class ARRenderer<StaticModelPolicy>;
@@ -0,0 +1,345 @@
+#include <AssetManager.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+AssetManager::AssetManager(const Options& options)
+    : options(options), compressTextures(TextureCache::s3tcSupported()) {
+    for (int i = 0; i < std::max(1, options.loaderThreads); ++i)
+        loaders.emplace_back([this] { loaderLoop(); });
+}
+
+AssetManager::~AssetManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    loadRequested.notify_all();
+    for (std::thread& loader : loaders) loader.join();
+    releaseAll();
+}
+
+bool readAssetManifest(const std::string& path, std::vector<AssetManifestEntry>& entries) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: No se pudo abrir el manifiesto de modelos " << path << std::endl;
+        return false;
+    }
+    const std::filesystem::path baseDir = std::filesystem::path(path).parent_path();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string id, objFile;
+        if (!(fields >> id >> objFile)) continue;
+        AssetManifestEntry entry;
+        const std::filesystem::path objPath = baseDir / objFile;
+        entry.objFile = objFile;
+        entry.objPath = objPath.string();
+        entry.mtlBasePath = objPath.parent_path().empty() ? "" : objPath.parent_path().string() + "/";
+        if (id == "*") {
+            entry.isDefault = true;
+        } else {
+            try {
+                entry.markerId = std::stoi(id);
+            } catch (const std::exception&) {
+                std::cerr << "Error: ID de marcador inválido '" << id << "' en la línea " << lineNumber << std::endl;
+                return false;
+            }
+        }
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+bool AssetManager::loadManifest(const std::string& path) {
+    std::vector<AssetManifestEntry> entries;
+    if (!readAssetManifest(path, entries)) return false;
+    for (const AssetManifestEntry& entry : entries) {
+        if (entry.isDefault)
+            mapDefault(entry.objPath, entry.mtlBasePath);
+        else
+            map(entry.markerId, entry.objPath, entry.mtlBasePath);
+    }
+    std::cout << "Manifiesto de modelos: " << entries.size() << " entradas, " << assets.size() << " modelos distintos"
+              << std::endl;
+    return !entries.empty();
+}
+
+bool AssetManager::loadPack(const std::string& path) {
+    if (!pack.open(path)) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<uint32_t> assetByPackIndex(pack.assetCount());
+    for (uint32_t i = 0; i < pack.assetCount(); ++i) {
+        const std::string name = "pack:" + std::string(pack.entry(i).name);
+        assetByPackIndex[i] = assetFor(name, "");
+        assets[assetByPackIndex[i]].packAsset = i;
+    }
+    for (uint32_t i = 0; i < pack.markerCount(); ++i) {
+        const AssetPackMarker& marker = pack.marker(i);
+        if (marker.markerId < 0)
+            defaultAsset = assetByPackIndex[marker.asset];
+        else
+            assetByMarker[marker.markerId] = assetByPackIndex[marker.asset];
+    }
+    std::cout << "Paquete de modelos: " << pack.assetCount() << " modelos, " << pack.markerCount() << " marcadores, "
+              << pack.fileSize() / 1024 << " KB proyectados" << std::endl;
+    return pack.markerCount() > 0;
+}
+
+void AssetManager::map(int markerId, const std::string& objPath, const std::string& mtlBasePath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    assetByMarker[markerId] = assetFor(objPath, mtlBasePath);
+}
+
+void AssetManager::mapDefault(const std::string& objPath, const std::string& mtlBasePath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    defaultAsset = assetFor(objPath, mtlBasePath);
+}
+
+// Con mutex tomado.
+uint32_t AssetManager::assetFor(const std::string& objPath, const std::string& mtlBasePath) {
+    auto it = assetByPath.find(objPath);
+    if (it != assetByPath.end()) return it->second;
+    const uint32_t index = (uint32_t)assets.size();
+    assets.emplace_back();
+    assets.back().objPath = objPath;
+    assets.back().mtlBasePath = mtlBasePath;
+    assetByPath[objPath] = index;
+    return index;
+}
+
+bool AssetManager::acquire(int markerId, Model& model, uint32_t& ref) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = assetByMarker.find(markerId);
+    const uint32_t index = it != assetByMarker.end() ? it->second : defaultAsset;
+    if (index == UINT32_MAX) return false;
+
+    Asset& asset = assets[index];
+    asset.lastSeen = ++seenClock;
+    if (asset.state == AssetState::Unloaded) {
+        asset.state = AssetState::Loading;
+        asset.requested = std::chrono::steady_clock::now();
+        loadQueue.push_back(index);
+        loadRequested.notify_one();
+    }
+    if (asset.state != AssetState::Resident) return false;
+    asset.refs++;
+    model = asset.model;
+    ref = index;
+    return true;
+}
+
+void AssetManager::release(std::vector<uint32_t>& refs) {
+    if (refs.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t index : refs) assets[index].refs--;
+    refs.clear();
+}
+
+void AssetManager::loaderLoop() {
+    while (true) {
+        uint32_t index;
+        std::string objPath, mtlBasePath;
+        uint32_t packAsset;
+        bool verified;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            loadRequested.wait(lock, [&] { return stopping || !loadQueue.empty(); });
+            if (stopping) return;
+            index = loadQueue.front();
+            loadQueue.pop_front();
+            objPath = assets[index].objPath;
+            mtlBasePath = assets[index].mtlBasePath;
+            packAsset = assets[index].packAsset;
+            verified = assets[index].verified;
+        }
+
+        // Del paquete no hay nada que parsear: solo se traen sus páginas y se comprueba
+        // la suma la primera vez, para que pump() no espere al disco.
+        std::unique_ptr<ModelData> data;
+        bool parsed;
+        if (packAsset != UINT32_MAX) {
+            pack.prefetch(pack.entry(packAsset));
+            parsed = verified || pack.verify(packAsset);
+            if (!parsed)
+                std::cerr << "Error: Suma incorrecta en el paquete para " << pack.entry(packAsset).name << std::endl;
+        } else {
+            data = std::make_unique<ModelData>();
+            parsed = parseObjModel(objPath, mtlBasePath, textureCache, *data, compressTextures);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Asset& asset = assets[index];
+        if (parsed) {
+            asset.data = std::move(data);
+            asset.verified = true;
+            asset.state = AssetState::Parsed;
+        } else {
+            // No se reintenta: el marcador queda sin modelo.
+            asset.state = AssetState::Failed;
+            counters.failures++;
+        }
+    }
+}
+
+void AssetManager::pump() {
+    finishUploads();
+    for (int uploads = 0; uploads < options.uploadsPerFrame; ++uploads) {
+        uint32_t index = UINT32_MAX;
+        uint32_t packAsset = UINT32_MAX;
+        std::shared_ptr<ModelData> data;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint32_t i = 0; i < assets.size() && index == UINT32_MAX; ++i) {
+                if (assets[i].state == AssetState::Parsed) index = i;
+            }
+            if (index == UINT32_MAX) break;
+            data = std::move(assets[index].data);
+            packAsset = assets[index].packAsset;
+            if (uploader) assets[index].state = AssetState::Uploading;
+        }
+
+        // La subida va fuera del mutex: acquire() no ve el modelo hasta que queda Resident.
+        auto upload = std::make_shared<PendingUpload>();
+        auto work = [this, upload, data, packAsset] {
+            upload->gpuBytes = packAsset != UINT32_MAX ? uploadPacked(packAsset, upload->model)
+                                                       : uploadModelResources(*data, textureCache, upload->model);
+        };
+        if (uploader) {
+            const size_t bytes =
+                packAsset != UINT32_MAX ? pack.entry(packAsset).vertexBytes : data->vertices.size() * sizeof(float);
+            const GpuUploader::Ticket ticket = uploader->submit(work, bytes);
+            std::lock_guard<std::mutex> lock(mutex);
+            assets[index].upload = upload;
+            assets[index].uploadTicket = ticket;
+            continue;
+        }
+        work();
+        attachVertexArray(upload->model);
+        std::lock_guard<std::mutex> lock(mutex);
+        makeResident(index, *upload);
+    }
+    evictOverBudget();
+}
+
+// Recoge las subidas cuyo fence ya se señaló.
+void AssetManager::finishUploads() {
+    if (!uploader) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (uint32_t i = 0; i < assets.size(); ++i) {
+        Asset& asset = assets[i];
+        if (asset.state != AssetState::Uploading || !uploader->poll(asset.uploadTicket)) continue;
+        attachVertexArray(asset.upload->model);
+        makeResident(i, *asset.upload);
+        asset.upload.reset();
+        asset.uploadTicket = 0;
+    }
+}
+
+// Con mutex tomado.
+void AssetManager::makeResident(uint32_t index, const PendingUpload& upload) {
+    Asset& asset = assets[index];
+    asset.model = upload.model;
+    asset.gpuBytes = upload.gpuBytes;
+    asset.state = AssetState::Resident;
+    counters.loads++;
+    counters.residentAssets++;
+    counters.residentBytes += upload.gpuBytes;
+    counters.peakResidentBytes = std::max(counters.peakResidentBytes, counters.residentBytes);
+    loadTimes.add(elapsedMs(asset.requested));
+}
+
+// Sube un modelo del paquete directamente desde la proyección, sin copias intermedias.
+// Como uploadModelResources, no arma el VAO.
+size_t AssetManager::uploadPacked(uint32_t packAsset, Model& model) {
+    const AssetPackEntry& entry = pack.entry(packAsset);
+    model.diffuseColor = glm::vec3(entry.diffuseColor[0], entry.diffuseColor[1], entry.diffuseColor[2]);
+    model.boundsMin = glm::vec3(entry.boundsMin[0], entry.boundsMin[1], entry.boundsMin[2]);
+    model.boundsMax = glm::vec3(entry.boundsMax[0], entry.boundsMax[1], entry.boundsMax[2]);
+    model.vertexCount = (int)entry.vertexCount;
+    createVertexBuffer(model, entry.vertexBytes, pack.vertices(entry));
+    size_t gpuBytes = entry.vertexBytes;
+    if (entry.mipLevels == 0) return gpuBytes;
+
+    // El paquete solo guarda S3TC; sin la extensión el modelo queda con su color difuso.
+    if (!compressTextures) {
+        std::cerr << "Aviso: Sin S3TC no se usa la textura de " << entry.name << " del paquete" << std::endl;
+        return gpuBytes;
+    }
+    std::vector<TextureCache::MipLevelView> levels(entry.mipLevels);
+    for (uint32_t level = 0; level < entry.mipLevels; ++level) {
+        const AssetPackMip& mip = pack.mip(entry, level);
+        levels[level] = {(int)mip.width, (int)mip.height, pack.mipData(mip), (size_t)mip.bytes};
+    }
+    TextureLoadInfo info;
+    model.diffuseTexture = textureCache.uploadCompressed(entry.name, entry.textureFormat, levels, &info);
+    ResourceTracker::instance().trackGLObject(true, model.diffuseTexture, ResourceCategory::GpuTextures,
+                                              info.gpuBytes);
+    return gpuBytes + info.gpuBytes;
+}
+
+// Desaloja los modelos sin referencias menos vistos recientemente. Si todos los que
+// sobran están en uso, el presupuesto se excede hasta que dejen de estarlo.
+void AssetManager::evictOverBudget() {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (counters.residentBytes > options.gpuBudgetBytes) {
+        uint32_t victim = UINT32_MAX;
+        for (uint32_t i = 0; i < assets.size(); ++i) {
+            const Asset& asset = assets[i];
+            if (asset.state != AssetState::Resident || asset.refs > 0) continue;
+            if (victim == UINT32_MAX || asset.lastSeen < assets[victim].lastSeen) victim = i;
+        }
+        if (victim == UINT32_MAX) break;
+
+        const auto evictStart = std::chrono::steady_clock::now();
+        Asset& asset = assets[victim];
+        releaseModelBuffers(asset.model);
+        counters.residentBytes -= asset.gpuBytes;
+        counters.residentAssets--;
+        counters.evictions++;
+        asset.gpuBytes = 0;
+        asset.state = AssetState::Unloaded;
+        evictTimes.add(elapsedMs(evictStart));
+    }
+}
+
+void AssetManager::releaseAll() {
+    // Las subidas encoladas terminan antes de borrar lo que crearon.
+    if (uploader) uploader->drain();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Asset& asset : assets) {
+        if (asset.state == AssetState::Uploading) {
+            releaseModelBuffers(asset.upload->model);
+            asset.upload.reset();
+            asset.state = AssetState::Unloaded;
+            continue;
+        }
+        if (asset.state != AssetState::Resident) continue;
+        releaseModelBuffers(asset.model);
+        asset.state = AssetState::Unloaded;
+        asset.gpuBytes = 0;
+    }
+    counters.residentBytes = 0;
+    counters.residentAssets = 0;
+}
+
+AssetManager::Stats AssetManager::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void AssetManager::printReport() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << "Modelos: " << counters.residentAssets << " residentes (" << counters.residentBytes / 1024
+              << " KB, pico " << counters.peakResidentBytes / 1024 << " KB de " << options.gpuBudgetBytes / 1024
+              << " KB de presupuesto), " << counters.loads << " cargas, " << counters.evictions << " desalojos, "
+              << counters.failures << " fallos" << std::endl;
+    loadTimes.print("Carga de modelo (primer avistamiento -> GPU)");
+    evictTimes.print("Desalojo de modelo");
+}
@@ -0,0 +1,179 @@
+#include <FramePacer.h>
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+void FramePacer::configure(const Options& newOptions) {
+    release();
+    options = newOptions;
+    options.fixedFps = std::max(1.0, options.fixedFps);
+    options.maxFramesInFlight = std::max(0, options.maxFramesInFlight);
+
+    switch (options.mode) {
+        case PacingMode::VSync: swapInterval = 1; break;
+        case PacingMode::Adaptive:
+            if (glfwExtensionSupported("GLX_EXT_swap_control_tear") ||
+                glfwExtensionSupported("WGL_EXT_swap_control_tear")) {
+                swapInterval = -1;
+            } else {
+                std::cout << "Aviso: Sin EXT_swap_control_tear, el ritmo adaptativo queda en vsync" << std::endl;
+                swapInterval = 1;
+            }
+            break;
+        case PacingMode::Uncapped:
+        case PacingMode::FixedRate: swapInterval = 0; break;
+    }
+    glfwSwapInterval(swapInterval);
+
+    haveLastSwap = frameStarted = haveSlot = false;
+    recentIntervals.clear();
+    recentWork.clear();
+    swapIntervals.reset();
+    frameWork.reset();
+    fenceWaits.reset();
+    latchWaits.reset();
+    slotWaits.reset();
+    missedDeadlines = 0;
+    skippedFrames = 0;
+}
+
+void FramePacer::waitForFrameStart() {
+    auto waitStart = std::chrono::steady_clock::now();
+    while (options.maxFramesInFlight > 0 && (int)inFlight.size() >= options.maxFramesInFlight) {
+        // Con tiempo de espera acotado para no colgarse si el driver pierde el fence.
+        const GLenum status = glClientWaitSync(inFlight.front(), GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+        if (status == GL_TIMEOUT_EXPIRED) continue;
+        glDeleteSync(inFlight.front());
+        inFlight.pop_front();
+    }
+    if (options.maxFramesInFlight > 0) fenceWaits.add(elapsedMs(waitStart));
+
+    if (options.lateLatch && options.mode != PacingMode::Uncapped && haveLastSwap && recentWork.size() >= 4) {
+        const double period = options.mode == PacingMode::FixedRate ? 1000.0 / options.fixedFps : refreshPeriodMs();
+        const auto present = options.mode == PacingMode::FixedRate && haveSlot
+                                 ? nextSlot + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                  std::chrono::duration<double, std::milli>(period))
+                                 : lastSwap + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                  std::chrono::duration<double, std::milli>(period));
+        const double budgetMs = recentPercentile(recentWork, 95) + options.latchMarginMs;
+        const auto latch = present - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                         std::chrono::duration<double, std::milli>(budgetMs));
+        waitStart = std::chrono::steady_clock::now();
+        if (latch > waitStart) std::this_thread::sleep_until(latch);
+        latchWaits.add(elapsedMs(waitStart));
+    }
+    frameStart = std::chrono::steady_clock::now();
+    frameStarted = true;
+}
+
+void FramePacer::beforeSwap() {
+    if (frameStarted) {
+        const double work = elapsedMs(frameStart);
+        frameWork.add(work);
+        pushRecent(recentWork, work);
+        frameStarted = false;
+    }
+    if (options.mode != PacingMode::FixedRate) return;
+
+    // Turnos fijos; si se quedó más de un periodo atrás, se vuelve a contar desde ahora
+    // en lugar de presentar varios fotogramas seguidos para ponerse al día.
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / options.fixedFps));
+    const auto now = std::chrono::steady_clock::now();
+    nextSlot = haveSlot ? nextSlot + period : now;
+    if (nextSlot + period < now) nextSlot = now;
+    haveSlot = true;
+    std::this_thread::sleep_until(nextSlot);
+    slotWaits.add(elapsedMs(now));
+}
+
+void FramePacer::afterSwap() {
+    const auto now = std::chrono::steady_clock::now();
+    if (haveLastSwap) {
+        const double interval = std::chrono::duration<double, std::milli>(now - lastSwap).count();
+        swapIntervals.add(interval);
+        pushRecent(recentIntervals, interval);
+        const double period = options.mode == PacingMode::FixedRate ? 1000.0 / options.fixedFps : refreshPeriodMs();
+        if (options.mode != PacingMode::Uncapped && interval > 1.5 * period) missedDeadlines++;
+    }
+    lastSwap = now;
+    haveLastSwap = true;
+    if (options.maxFramesInFlight > 0) inFlight.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+void FramePacer::frameSkipped() {
+    haveLastSwap = frameStarted = false;
+    skippedFrames++;
+}
+
+void FramePacer::release() {
+    for (GLsync fence : inFlight) glDeleteSync(fence);
+    inFlight.clear();
+}
+
+void FramePacer::printReport() const {
+    if (swapIntervals.count() == 0) return;
+    // Jitter sobre los intervalos retenidos, con su propia media.
+    const size_t retained = swapIntervals.size();
+    double windowMean = 0.0, variance = 0.0;
+    for (size_t i = 0; i < retained; ++i) windowMean += swapIntervals.sample(i);
+    windowMean /= retained;
+    for (size_t i = 0; i < retained; ++i) {
+        const double d = swapIntervals.sample(i) - windowMean;
+        variance += d * d;
+    }
+    const double jitter = std::sqrt(variance / retained);
+    std::cout << "Ritmo " << modeName(options.mode) << " (intervalo de intercambio " << swapInterval;
+    if (options.mode == PacingMode::FixedRate) std::cout << ", " << options.fixedFps << " fps";
+    if (options.maxFramesInFlight > 0) std::cout << ", máx. " << options.maxFramesInFlight << " en vuelo";
+    if (options.lateLatch) std::cout << ", late latch";
+    std::cout << "): " << 1000.0 / std::max(1e-9, swapIntervals.mean()) << " fps, jitter " << jitter
+              << " ms (desv. típica), p1-p99 " << swapIntervals.percentile(1) << "-" << swapIntervals.percentile(99)
+              << " ms, " << missedDeadlines << " refrescos perdidos";
+    if (skippedFrames) std::cout << " (solo fotogramas dibujados; " << skippedFrames << " omitidos sin intercambio)";
+    std::cout << std::endl;
+    frameWork.print("  Inicio del fotograma a intercambio");
+    fenceWaits.print("  Espera de fotogramas en vuelo");
+    latchWaits.print("  Espera de late latch");
+    slotWaits.print("  Espera del turno fijo");
+}
+
+const char* FramePacer::modeName(PacingMode mode) {
+    switch (mode) {
+        case PacingMode::VSync: return "vsync";
+        case PacingMode::Adaptive: return "adaptive";
+        case PacingMode::Uncapped: return "uncapped";
+        case PacingMode::FixedRate: return "fixed";
+    }
+    return "?";
+}
+
+bool FramePacer::parseMode(const std::string& name, PacingMode& mode) {
+    for (PacingMode candidate : {PacingMode::VSync, PacingMode::Adaptive, PacingMode::Uncapped, PacingMode::FixedRate}) {
+        if (name == modeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Mediana de los últimos intervalos: sin medidas todavía se supone 60 Hz.
+double FramePacer::refreshPeriodMs() const {
+    return recentIntervals.empty() ? 1000.0 / 60.0 : recentPercentile(recentIntervals, 50);
+}
+
+double FramePacer::recentPercentile(const std::deque<double>& values, double p) {
+    std::vector<double> sorted(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[std::min(sorted.size() - 1, (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5))];
+}
+
+void FramePacer::pushRecent(std::deque<double>& values, double value) {
+    values.push_back(value);
+    if (values.size() > 60) values.pop_front();
+}
@@ -0,0 +1,116 @@
+#include <GpuUploader.h>
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+bool GpuUploader::start(GLFWwindow* shareWith) {
+    if (running()) return true;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context = glfwCreateWindow(1, 1, "subidas", nullptr, shareWith);
+    // Las pistas son globales: sin esto la próxima ventana también saldría oculta.
+    glfwDefaultWindowHints();
+    if (!context) {
+        std::cerr << "Aviso: No se pudo crear el contexto compartido; las subidas siguen en el hilo de render"
+                  << std::endl;
+        return false;
+    }
+    stopping = false;
+    worker = std::thread([this] { run(); });
+    return true;
+}
+
+void GpuUploader::stop() {
+    if (!running()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobQueued.notify_all();
+    worker.join();
+
+    // Los fences se comparten entre contextos: se borran desde el principal.
+    for (auto& entry : completed) glDeleteSync(entry.second.fence);
+    completed.clear();
+    glfwDestroyWindow(context);
+    context = nullptr;
+}
+
+GpuUploader::Ticket GpuUploader::submit(std::function<void()> work, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Job job;
+    job.ticket = nextTicket++;
+    job.work = std::move(work);
+    job.bytes = bytes;
+    job.queued = std::chrono::steady_clock::now();
+    const Ticket ticket = job.ticket;
+    jobs.push_back(std::move(job));
+    jobQueued.notify_one();
+    return ticket;
+}
+
+bool GpuUploader::poll(Ticket ticket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = completed.find(ticket);
+    if (it == completed.end()) return false;
+    const GLenum status = glClientWaitSync(it->second.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+    glDeleteSync(it->second.fence);
+    readyTimes.add(elapsedMs(it->second.queued));
+    completed.erase(it);
+    return true;
+}
+
+void GpuUploader::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobDone.wait(lock, [&] { return !running() || (jobs.empty() && !busy); });
+}
+
+void GpuUploader::run() {
+    glfwMakeContextCurrent(context);
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobQueued.wait(lock, [&] { return stopping || !jobs.empty(); });
+            // Al parar se ejecuta lo pendiente: quien lo encoló espera sus objetos.
+            if (jobs.empty()) break;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        job.work();
+        // El flush hace que el fence llegue a la GPU y el otro contexto pueda verlo.
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        const double ms = elapsedMs(start);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            completed[job.ticket] = {fence, job.queued};
+            busy = false;
+            counters.jobs++;
+            counters.bytes += (long long)job.bytes;
+            jobTimes.add(ms);
+        }
+        jobDone.notify_all();
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+GpuUploader::Stats GpuUploader::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void GpuUploader::printReport() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (counters.jobs == 0) return;
+    std::cout << "Hilo de subidas: " << counters.jobs << " trabajos, " << counters.bytes / 1024 << " KB" << std::endl;
+    jobTimes.print("Subida en el contexto compartido");
+    readyTimes.print("Subida encolada -> lista en la GPU");
+}
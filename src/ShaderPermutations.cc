@@ -0,0 +1,243 @@
+#include <ShaderPermutations.h>
+
+#include <GLFW/glfw3.h>
+#include <cstring>
+#include <iostream>
+
+ShaderPermutations::ShaderPermutations(std::string name, const char* vertexBody, const char* fragmentBody,
+                                       std::vector<std::string> featureDefines, std::vector<std::string> uniformNames)
+    : name(std::move(name)), vertexBody(vertexBody), fragmentBody(fragmentBody),
+      featureDefines(std::move(featureDefines)), uniformNames(std::move(uniformNames)) {
+    slotCount = 1u << this->featureDefines.size();
+    slots = std::make_unique<Slot[]>(slotCount);
+}
+
+bool ShaderPermutations::init() {
+    parallel = parallelCompileSupported();
+    if (parallel) {
+        // Sin límite: el driver usa tantos hilos como crea conveniente.
+        using MaxThreadsFn = void (*)(GLuint);
+        auto maxThreads = reinterpret_cast<MaxThreadsFn>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+        if (!maxThreads)
+            maxThreads = reinterpret_cast<MaxThreadsFn>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+        if (maxThreads) maxThreads(0xFFFFFFFFu);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::string vs = source(vertexBody, 0), fs = source(fragmentBody, 0);
+    const GLuint program = buildProgram(vs.c_str(), fs.c_str(), name + " (básico)");
+    basicCompileMs = elapsedMs(start);
+    if (program == 0) return false;
+    finish(0, program);
+    return true;
+}
+
+void ShaderPermutations::request(uint32_t features, GpuUploader* worker) {
+    if (features >= slotCount) return;
+    Slot& slot = slots[features];
+    if (slot.state != State::Idle) return;
+    slot.requested = std::chrono::steady_clock::now();
+    slot.state = State::Compiling;
+
+    const std::string vs = source(vertexBody, features), fs = source(fragmentBody, features);
+    if (parallel) {
+        // Con la extensión, compilar y enlazar solo encolan el trabajo en el driver.
+        slot.mode = Mode::Parallel;
+        const char* vsSource = vs.c_str();
+        const char* fsSource = fs.c_str();
+        slot.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(slot.vertexShader, 1, &vsSource, nullptr);
+        glCompileShader(slot.vertexShader);
+        slot.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(slot.fragmentShader, 1, &fsSource, nullptr);
+        glCompileShader(slot.fragmentShader);
+        slot.program = glCreateProgram();
+        glAttachShader(slot.program, slot.vertexShader);
+        glAttachShader(slot.program, slot.fragmentShader);
+        glLinkProgram(slot.program);
+    } else if (worker && worker->running()) {
+        // Los programas se comparten entre contextos; el fence del trabajo garantiza
+        // que el enlazado terminó antes de usarlo aquí.
+        slot.mode = Mode::Worker;
+        slot.worker = worker;
+        slot.workerProgram = std::make_shared<GLuint>(0);
+        const std::string label = name + " (" + featureLabel(features) + ")";
+        slot.ticket = worker->submit([vs, fs, label, result = slot.workerProgram] {
+            *result = buildProgram(vs.c_str(), fs.c_str(), label);
+        });
+    } else {
+        slot.mode = Mode::Sync;
+    }
+}
+
+void ShaderPermutations::poll() {
+    bool syncCompiled = false;
+    for (uint32_t features = 1; features < slotCount; ++features) {
+        Slot& slot = slots[features];
+        if (slot.state != State::Compiling) continue;
+
+        if (slot.mode == Mode::Parallel) {
+            GLint done = GL_FALSE;
+            glGetProgramiv(slot.program, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done) continue;
+            const bool linked = linkSucceeded(slot.program, name + " (" + featureLabel(features) + ")");
+            glDetachShader(slot.program, slot.vertexShader);
+            glDetachShader(slot.program, slot.fragmentShader);
+            glDeleteShader(slot.vertexShader);
+            glDeleteShader(slot.fragmentShader);
+            slot.vertexShader = slot.fragmentShader = 0;
+            if (!linked) {
+                glDeleteProgram(slot.program);
+                slot.program = 0;
+            }
+            finish(features, slot.program);
+        } else if (slot.mode == Mode::Worker) {
+            if (!slot.worker->poll(slot.ticket)) continue;
+            finish(features, *slot.workerProgram);
+            slot.workerProgram.reset();
+        } else if (!syncCompiled) {
+            // Sin ayuda de nadie: a lo sumo una variante por fotograma.
+            const std::string vs = source(vertexBody, features), fs = source(fragmentBody, features);
+            finish(features, buildProgram(vs.c_str(), fs.c_str(), name + " (" + featureLabel(features) + ")"));
+            syncCompiled = true;
+        }
+    }
+}
+
+const ShaderPermutations::Variant& ShaderPermutations::select(uint32_t features) const {
+    if (features < slotCount && slots[features].ready.load(std::memory_order_acquire))
+        return slots[features].variant;
+    return slots[0].variant;
+}
+
+void ShaderPermutations::destroy() {
+    for (uint32_t features = 0; features < slotCount; ++features) {
+        Slot& slot = slots[features];
+        // Una compilación en el hilo de subidas ya terminó: GpuUploader::stop() ejecuta lo pendiente.
+        if (slot.workerProgram && *slot.workerProgram) glDeleteProgram(*slot.workerProgram);
+        if (slot.vertexShader) glDeleteShader(slot.vertexShader);
+        if (slot.fragmentShader) glDeleteShader(slot.fragmentShader);
+        if (slot.state == State::Compiling && slot.mode == Mode::Parallel) glDeleteProgram(slot.program);
+        if (slot.variant.program) glDeleteProgram(slot.variant.program);
+        slot.ready.store(false, std::memory_order_relaxed);
+        slot.variant = Variant();
+        slot.state = State::Idle;
+        slot.vertexShader = slot.fragmentShader = slot.program = 0;
+        slot.workerProgram.reset();
+    }
+}
+
+void ShaderPermutations::printReport() const {
+    static const char* modeNames[] = {"en el hilo de GL", "en paralelo (driver)", "en el hilo de subidas"};
+    std::cout << "Shaders " << name << ": básico en " << basicCompileMs << " ms" << std::endl;
+    for (uint32_t features = 1; features < slotCount; ++features) {
+        const Slot& slot = slots[features];
+        if (slot.state == State::Idle) continue;
+        std::cout << "  " << featureLabel(features) << ": ";
+        if (slot.state == State::Ready)
+            std::cout << "lista " << slot.readyMs << " ms después de pedirla, " << modeNames[(int)slot.mode];
+        else if (slot.state == State::Failed)
+            std::cout << "falló, se usa la básica";
+        else
+            std::cout << "aún compilando";
+        std::cout << std::endl;
+    }
+}
+
+std::string ShaderPermutations::source(const char* body, uint32_t features) const {
+    std::string text = "#version 330 core\n";
+    for (size_t i = 0; i < featureDefines.size(); ++i) {
+        if (features & (1u << i)) text += "#define " + featureDefines[i] + "\n";
+    }
+    return text + body;
+}
+
+std::string ShaderPermutations::featureLabel(uint32_t features) const {
+    std::string label;
+    for (size_t i = 0; i < featureDefines.size(); ++i) {
+        if (!(features & (1u << i))) continue;
+        if (!label.empty()) label += "+";
+        label += featureDefines[i];
+    }
+    return label.empty() ? "básico" : label;
+}
+
+// Publica la variante: las ubicaciones se escriben antes del store con release.
+void ShaderPermutations::finish(uint32_t features, GLuint program) {
+    Slot& slot = slots[features];
+    slot.readyMs = elapsedMs(slot.requested);
+    if (program == 0) {
+        slot.state = State::Failed;
+        return;
+    }
+    slot.variant.program = program;
+    slot.variant.uniforms.clear();
+    for (const std::string& uniform : uniformNames)
+        slot.variant.uniforms.push_back(glGetUniformLocation(program, uniform.c_str()));
+    slot.program = 0;
+    slot.state = State::Ready;
+    slot.ready.store(true, std::memory_order_release);
+}
+
+GLuint ShaderPermutations::buildProgram(const char* vertexSource, const char* fragmentSource,
+                                        const std::string& label) {
+    auto compile = [&label](GLenum type, const char* text) -> GLuint {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &text, nullptr);
+        glCompileShader(shader);
+        int success;
+        char infoLog[512];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            std::cerr << "Error en la compilación del shader " << label << ": " << infoLog << std::endl;
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    };
+
+    GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    if (!linkSucceeded(program, label)) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+bool ShaderPermutations::linkSucceeded(GLuint program, const std::string& label) {
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << "Error en el enlazado del programa de shaders " << label << ": " << infoLog << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ShaderPermutations::parallelCompileSupported() {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (ext && (std::strcmp(ext, "GL_KHR_parallel_shader_compile") == 0 ||
+                    std::strcmp(ext, "GL_ARB_parallel_shader_compile") == 0))
+            return true;
+    }
+    return false;
+}
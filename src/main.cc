@@ -1,30 +1,90 @@
+#include <filesystem>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <opencv2/aruco.hpp>
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <thread>
 #include <vector>
 
-#include <ARObjectRenderer.h>
+#include <AppConfig.h>
+#include <ARRenderer.h>
+#include <AssetManager.h>
+#include <AsyncFileWriter.h>
+#include <FrameChannel.h>
+#include <FrameRecorder.h>
+#include <FrameSource.h>
+#include <HandGestureDetector.h>
+#include <IdleGovernor.h>
+#include <JpegFrameSource.h>
+#include <LatencyProbe.h>
+#include <NumaPlacement.h>
+#include <ParallelVideoSource.h>
+#include <RenderCommandList.h>
+#include <ResourceTracker.h>
+#include <StartupTrace.h>
+#include <VisionPipeline.h>
+
+// Fotograma capturado junto con los comandos de render grabados para él.
+struct FramePacket {
+  cv::Mat frame;
+  VisionFrame vision;
+  RenderCommandList commands;
+  TrackedAllocation frameBytes{ResourceCategory::FrameBuffers};
+
+  void trackFrame() { frameBytes.set(frame.total() * frame.elemSize()); }
+};
 
 class AugmentedRealityApp {
 private:
-  cv::VideoCapture cap;
+  std::unique_ptr<FrameSource> source;
   cv::Mat cameraMatrix, distCoeffs;
   cv::aruco::Dictionary dictionary;
   cv::aruco::ArucoDetector detector;
+  HandGestureDetector gestureDetector;
+  AppConfig config;
+  NumaPlacement &numa;
+
+  static constexpr float markerLength_m = 0.05f;
+
+  // Destino del pipeline interactivo: graba el fotograma y su pose.
+  struct RecordSink {
+    AugmentedRealityApp *app;
+    void consume(VisionFrame &frame) {
+      app->recordFrame(frame.image, frame.markerFound, frame.rvec, frame.tvec);
+    }
+  };
+  // Configuración de producción con ventana, instanciada en compilación.
+  VisionPipeline<NoSource, ArucoDetectorStage, PnPPoseStage, HandGestureStage, RecordSink> interactiveVision;
+
+  // Salida a disco compartida: grabación, registro de poses y traza de arranque.
+  AsyncFileWriter fileWriter;
+  std::unique_ptr<MjpegRecorder> recorder;
+  std::unique_ptr<PoseLog> poseLog;
+  long long recordedFrames = 0;
   
   // --- INSTANCIA DEL RENDERIZADOR ---
   ARObjectRenderer renderer;
+  // Con --assets: un modelo por marcador. Se declara después del renderizador para
+  // destruirse antes que el contexto de GL.
+  std::unique_ptr<AssetManager> assets;
+  std::vector<MarkerPose> markerPoses;
+  StartupTrace startupTrace;
+  IdleGovernor idleGovernor;
 
   bool isCalibrated = false;
   std::string calibrationFilePath = "calibration_data.yml";
 
   const cv::Size boardSize{9, 6};
   const float squareSize_m = 0.025f;
-  const float markerLength_m = 0.05f;
+  const cv::Size defaultWindowSize{640, 480};
+  const std::string modelPath = "../../rata-centrada.obj";
+  const std::string modelMtlBasePath = "../../";
+  size_t currentModel = 0; // 0 = modelPath, i = config.swapModelPaths[i - 1]
 
 public:
-  AugmentedRealityApp();
+  AugmentedRealityApp(const AppConfig &config, NumaPlacement &numa);
   ~AugmentedRealityApp();
   void run();
 
@@ -32,24 +92,30 @@ private:
   bool loadCalibration();
   void saveCalibration();
   void performCalibration();
-  void detectAndRender(cv::Mat &frame); 
-  bool detectHandGesture(const cv::Mat &inputFrame);
+  std::unique_ptr<FrameSource> openSource() const;
+  void useApproximateIntrinsics(cv::Size frameSize);
+  bool openOutputs();
+  void recordFrame(const cv::Mat &frame, bool found, const cv::Vec3d &rvec, const cv::Vec3d &tvec);
+  void detectAndBuild(FramePacket &packet);
+  void runHeadless();
+  template <typename Pipeline> long long runHeadlessLoop(Pipeline &pipeline);
+  void runLatencyTest();
+  void runSerial(long long maxFrames = 0, LatencyProbe *probe = nullptr);
+  void runPipelined(bool latestFrameWins, long long maxFrames = 0, LatencyProbe *probe = nullptr);
+  void checkModelSwap();
+  void presentFrame(FramePacket &packet, LatencyProbe *probe);
+  void sampleFrameResidency(const cv::Mat &frame);
 };
 
-AugmentedRealityApp::AugmentedRealityApp()
+AugmentedRealityApp::AugmentedRealityApp(const AppConfig &config, NumaPlacement &numa)
     : dictionary(cv::aruco::getPredefinedDictionary(cv::aruco::DICT_6X6_250)),
-      detector(dictionary) {
-  cap.open(0);
-  if (!cap.isOpened()) {
-    std::cerr << "FATAL: No se pudo abrir la cámara." << std::endl;
-    exit(-1);
-  }
-  isCalibrated = loadCalibration();
-}
+      detector(dictionary), config(config), numa(numa),
+      interactiveVision(NoSource{}, ArucoDetectorStage{&detector},
+                        PnPPoseStage(&cameraMatrix, &distCoeffs, markerLength_m, !config.assetManifestPath.empty()),
+                        HandGestureStage{&gestureDetector}, RecordSink{this}),
+      idleGovernor(IdleGovernor::Options{config.idleAfterSeconds, config.idleFps}) {}
 
 AugmentedRealityApp::~AugmentedRealityApp() {
-  if (cap.isOpened())
-    cap.release();
   std::cout << "Aplicación finalizada." << std::endl;
 }
 
@@ -94,8 +160,7 @@ void AugmentedRealityApp::performCalibration() {
     const int requiredImages = 20;
 
     while (imagePoints.size() < requiredImages) {
-        cap >> frame;
-        if (frame.empty()) continue;
+        if (!source->read(frame)) continue;
 
         cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
         std::vector<cv::Point2f> corners;
@@ -132,39 +197,108 @@ void AugmentedRealityApp::performCalibration() {
     saveCalibration();
 }
 
-void AugmentedRealityApp::detectAndRender(cv::Mat &frame) {
-  std::vector<int> markerIds;
-  std::vector<std::vector<cv::Point2f>> markerCorners;
-  detector.detectMarkers(frame, markerCorners, markerIds);
-
-  cv::Vec3d rvec, tvec;
-  rvec = cv::Vec3d(0,0,0);
-  tvec = cv::Vec3d(0,0,0);
-  bool markerFound = false;
-
-  if (!markerIds.empty()) {
-    markerFound = true;
-    std::vector<cv::Point3f> objPoints = {
-        cv::Point3f(-markerLength_m / 2.f, markerLength_m / 2.f, 0),
-        cv::Point3f(markerLength_m / 2.f, markerLength_m / 2.f, 0),
-        cv::Point3f(markerLength_m / 2.f, -markerLength_m / 2.f, 0),
-        cv::Point3f(-markerLength_m / 2.f, -markerLength_m / 2.f, 0)};
-
-    cv::solvePnP(objPoints, markerCorners[0], cameraMatrix, distCoeffs, rvec, tvec);
-    
-    cv::drawFrameAxes(frame, cameraMatrix, distCoeffs, rvec, tvec, markerLength_m * 0.7f, 3);
-  }
+// Cámara 0 por defecto; con --input, JPEG (secuencias, MJPEG) si se puede
+// decodificar reducido, o si no un video decodificado por segmentos en paralelo.
+std::unique_ptr<FrameSource> AugmentedRealityApp::openSource() const {
+  if (config.inputPath.empty())
+    return std::make_unique<CameraFrameSource>(0);
+  if (auto jpeg = JpegFrameSource::open(config.inputPath, config.visionReduction))
+    return jpeg;
+  return std::make_unique<ParallelVideoFrameSource>(config.inputPath, config.decodeThreads);
+}
 
-  if (markerFound && detectHandGesture(frame)) {
+// Intrínsecos aproximados para fuentes sin calibración: basta para ejercitar
+// solvePnP y el render.
+void AugmentedRealityApp::useApproximateIntrinsics(cv::Size frameSize) {
+  cameraMatrix = (cv::Mat_<double>(3, 3) << frameSize.width, 0, frameSize.width / 2.0,
+                  0, frameSize.width, frameSize.height / 2.0, 0, 0, 1);
+  distCoeffs = cv::Mat::zeros(1, 5, CV_64F);
+}
+
+void AugmentedRealityApp::detectAndBuild(FramePacket &packet) {
+  cv::Mat &frame = packet.frame;
+  VisionFrame &vision = packet.vision;
+  vision.image = frame;
+  vision.scale = 1.0;
+  interactiveVision.process(vision);
+
+  if (vision.markerFound)
+    cv::drawFrameAxes(frame, cameraMatrix, distCoeffs, vision.rvec, vision.tvec, markerLength_m * 0.7f, 3);
+  if (vision.gesture) {
     cv::putText(frame, "GESTO: PUNO CERRADO!", cv::Point(10, 30),
                 cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 0, 255), 2);
     renderer.triggerAnimation();
   }
-  renderer.render(frame, rvec, tvec, cameraMatrix);
+  if (assets) {
+    // markerPoses solo lo usa el hilo que detecta.
+    markerPoses.clear();
+    if (vision.markerFound) {
+      for (size_t i = 0; i < vision.markerIds.size(); ++i)
+        markerPoses.push_back({vision.markerIds[i], vision.rvecs[i], vision.tvecs[i]});
+    }
+    renderer.buildCommands(packet.commands, frame.size(), markerPoses, cameraMatrix);
+    for (const std::vector<cv::Point2f> &corners : vision.markerCorners)
+      renderer.addMarkerOverlay(packet.commands, corners, frame.size());
+    return;
+  }
+  renderer.buildCommands(packet.commands, frame.size(), vision.rvec, vision.tvec, cameraMatrix);
+  if (vision.markerFound)
+    renderer.addMarkerOverlay(packet.commands, vision.markerCorners[0], frame.size());
 }
 
+// Arranque: abrir la cámara (que en V4L2 puede tardar un segundo), leer la
+// calibración y parsear el modelo corren en paralelo; el hilo principal crea la
+// ventana y compila los shaders mientras tanto. Todo lo de GL queda en este hilo.
+// La ventana nace con un tamaño por defecto y se ajusta cuando la cámara anuncia
+// el suyo, sin esperar al primer fotograma.
 void AugmentedRealityApp::run() {
-  if (!isCalibrated) {
+  if (config.latencyTestFrames > 0) {
+    isCalibrated = loadCalibration();
+    runLatencyTest();
+    return;
+  }
+  if (!openOutputs())
+    return;
+  if (config.headless) {
+    isCalibrated = loadCalibration();
+    runHeadless();
+    return;
+  }
+
+  startupTrace.begin(config.startupTracePath);
+
+  // Con --assets cada marcador dibuja el modelo del manifiesto: el modelo único no
+  // se usa y no se parsea ni se sube.
+  const bool singleModel = config.assetManifestPath.empty();
+  ModelData modelData;
+  auto cameraReady = startupTrace.launch("camera.open", [this] { return openSource(); });
+  auto calibrationReady = startupTrace.launch("calibration.load", [this] { return loadCalibration(); });
+  std::future<bool> modelReady;
+  if (singleModel) {
+    modelReady = startupTrace.launch("model.parse", [&] {
+      return renderer.parseModel(modelPath, modelMtlBasePath, modelData);
+    });
+  }
+
+  auto waitForCamera = [&] {
+    if (source) return true;
+    StartupTrace::Span span(startupTrace, "camera.wait");
+    source = cameraReady.get();
+    if (!source->isOpened()) {
+      std::cerr << "FATAL: No se pudo abrir la cámara." << std::endl;
+      return false;
+    }
+    return true;
+  };
+
+  isCalibrated = calibrationReady.get();
+  if (!isCalibrated && !config.inputPath.empty()) {
+    // Un video grabado no se puede calibrar de forma interactiva.
+    if (!waitForCamera()) return;
+    useApproximateIntrinsics(source->frameSize());
+  } else if (!isCalibrated) {
+    // La calibración interactiva necesita la cámara antes que la ventana de GL.
+    if (!waitForCamera()) return;
     performCalibration();
     if (!isCalibrated) {
       std::cerr << "La aplicación no puede continuar sin calibración. Saliendo." << std::endl;
@@ -172,84 +306,345 @@ void AugmentedRealityApp::run() {
     }
   }
 
-  cv::Mat tempFrame;
-  cap >> tempFrame;
-  if(!renderer.init(tempFrame.cols, tempFrame.rows, "Proyecto Final AR - OpenGL")) {
+  {
+    StartupTrace::Span span(startupTrace, "gl.init");
+    if (!renderer.init(defaultWindowSize.width, defaultWindowSize.height, "Proyecto Final AR - OpenGL")) {
       std::cerr << "Fallo al inicializar el renderizador de OpenGL." << std::endl;
       return;
+    }
+  }
+  renderer.setModelRenderScale(config.modelRenderScale);
+  renderer.setCompositeMode(config.compositeMode);
+  renderer.setFramePacing(config.pacing);
+  if (config.uploadThread) {
+    StartupTrace::Span span(startupTrace, "gl.upload_context");
+    renderer.startUploadThread();
+  }
+  if (!config.assetManifestPath.empty()) {
+    AssetManager::Options options;
+    options.gpuBudgetBytes = (size_t)config.gpuBudgetMb * 1024 * 1024;
+    assets = std::make_unique<AssetManager>(options);
+    const bool loaded = AssetPack::isPack(config.assetManifestPath) ? assets->loadPack(config.assetManifestPath)
+                                                                    : assets->loadManifest(config.assetManifestPath);
+    if (!loaded)
+      return;
+    assets->setUploader(renderer.getUploader());
+    renderer.setAssetManager(assets.get());
   }
 
-  std::string objPath = "../../rata-centrada.obj";
-  std::string mtlBasePath = "../../";
-  if (!renderer.loadModel(objPath, mtlBasePath)) {
+  if (singleModel) {
+    StartupTrace::Span span(startupTrace, "model.upload");
+    if (!modelReady.get() || !renderer.uploadModel(modelData)) {
       std::cerr << "Fallo al cargar el modelo 3D. Saliendo." << std::endl;
       return;
+    }
   }
 
+  if (!waitForCamera()) return;
+  const cv::Size cameraSize = source->frameSize();
+  renderer.resizeWindow(cameraSize.width, cameraSize.height);
+
   std::cout << "\n--- INICIANDO DETECCION ---" << std::endl;
   std::cout << "Apunte la camara a un marcador ArUco." << std::endl;
   std::cout << "Cierre la ventana para salir." << std::endl;
 
-  cv::Mat frame;
-  while (!renderer.windowShouldClose()) {
-    cap >> frame;
-    if (frame.empty()) break;
-    
-    detectAndRender(frame);
-    
-    renderer.pollEventsAndSwapBuffers();
+  renderer.setDamageTracking(!config.alwaysRedraw);
+  idleGovernor.start();
+  if (config.pipelineMode == PipelineMode::Serial)
+    runSerial();
+  else
+    runPipelined(config.pipelineMode == PipelineMode::LatestFrameWins);
+
+  renderer.printReport();
+  idleGovernor.printReport();
+  if (assets)
+    assets->printReport();
+  numa.printReport();
+}
+
+// Bucle común de --headless para cualquier instancia del pipeline de visión.
+template <typename Pipeline> long long AugmentedRealityApp::runHeadlessLoop(Pipeline &pipeline) {
+  VisionFrame frame;
+  TrackedAllocation frameBytes(ResourceCategory::FrameBuffers);
+  TimingStats frameTimes;
+  long long frames = 0;
+  while (true) {
+    const auto frameStart = std::chrono::steady_clock::now();
+    if (!pipeline.step(frame)) break;
+    frameBytes.set(frame.image.total() * frame.image.elemSize());
+    frames++;
+    frameTimes.add(elapsedMs(frameStart));
+    if (ResourceTracker::instance().consumeDumpRequest())
+      ResourceTracker::instance().printReport();
   }
+  frameTimes.print("Fotograma sin ventana (lectura + detección)");
+  sampleFrameResidency(frame.image);
+  return frames;
 }
 
-bool AugmentedRealityApp::detectHandGesture(const cv::Mat &inputFrame) {
-    cv::Mat hsvFrame, skinMask;
-    cv::cvtColor(inputFrame, hsvFrame, cv::COLOR_BGR2HSV);
-    cv::inRange(hsvFrame, cv::Scalar(0, 48, 80), cv::Scalar(20, 255, 255), skinMask);
-
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(7, 7));
-    cv::morphologyEx(skinMask, skinMask, cv::MORPH_OPEN, kernel);
-    cv::morphologyEx(skinMask, skinMask, cv::MORPH_CLOSE, kernel);
-
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(skinMask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-
-    double maxArea = 0;
-    int maxAreaIdx = -1;
-    for (size_t i = 0; i < contours.size(); i++) {
-        double area = cv::contourArea(contours[i]);
-        if (area > maxArea) {
-            maxArea = area;
-            maxAreaIdx = i;
-        }
+// Sin ventana ni GL: solo detección y pose sobre la fuente (típicamente un video
+// con --input), tan rápido como la fuente entregue fotogramas. Para las fuentes
+// conocidas el pipeline se instancia con su tipo concreto; --dynamic-vision (o una
+// fuente sin instancia propia) usa el pipeline de std::function.
+void AugmentedRealityApp::runHeadless() {
+  source = openSource();
+  if (!source->isOpened()) {
+    std::cerr << "FATAL: No se pudo abrir la fuente de video." << std::endl;
+    return;
+  }
+  // Sin calibración, PnPPoseStage toma intrínsecos aproximados del primer fotograma.
+  if (!isCalibrated) {
+    cameraMatrix.release();
+    distCoeffs.release();
+  }
+
+  long long posesFound = 0;
+  // El fotograma completo solo se decodifica si hay que grabarlo.
+  auto sink = makeCallbackSink([this, &posesFound](VisionFrame &frame) {
+    if (frame.markerFound)
+      posesFound++;
+    if (recorder && frame.scale != 1.0) {
+      cv::Mat fullFrame;
+      source->fullFrame(fullFrame);
+      recordFrame(fullFrame, frame.markerFound, frame.rvec, frame.tvec);
+    } else {
+      recordFrame(frame.image, frame.markerFound, frame.rvec, frame.tvec);
     }
+  });
+  const ArucoDetectorStage detectorStage{&detector};
+  const PnPPoseStage poseStage(&cameraMatrix, &distCoeffs, markerLength_m);
+
+  long long frames = 0;
+  const auto start = std::chrono::steady_clock::now();
+  if (config.dynamicVisionPipeline) {
+    DynamicVisionPipeline pipeline(
+        DynamicSource{[this](VisionFrame &frame) { return source->readForVision(frame.image, frame.scale); }},
+        DynamicStage{[stage = detectorStage](VisionFrame &frame) mutable { stage.detect(frame); }},
+        DynamicStage{[stage = poseStage](VisionFrame &frame) mutable { stage.solve(frame); }},
+        DynamicStage{}, DynamicStage{sink.callback});
+    frames = runHeadlessLoop(pipeline);
+  } else if (auto *jpeg = dynamic_cast<JpegFrameSource *>(source.get())) {
+    auto pipeline = makeVisionPipeline(FrameSourceStage<JpegFrameSource>{jpeg}, detectorStage, poseStage,
+                                       NoGesture{}, sink);
+    frames = runHeadlessLoop(pipeline);
+  } else if (auto *video = dynamic_cast<ParallelVideoFrameSource *>(source.get())) {
+    auto pipeline = makeVisionPipeline(FrameSourceStage<ParallelVideoFrameSource>{video}, detectorStage, poseStage,
+                                       NoGesture{}, sink);
+    frames = runHeadlessLoop(pipeline);
+  } else {
+    auto pipeline = makeVisionPipeline(FrameSourceStage<FrameSource>{source.get()}, detectorStage, poseStage,
+                                       NoGesture{}, sink);
+    frames = runHeadlessLoop(pipeline);
+  }
 
-    if (maxAreaIdx != -1 && maxArea > 8000) { // Umbral de área para evitar ruido
-        std::vector<int> hullIndices;
-        cv::convexHull(contours[maxAreaIdx], hullIndices, false); // 'false' para obtener índices
-
-        if (hullIndices.size() > 3) {
-            std::vector<cv::Vec4i> defects;
-            cv::convexityDefects(contours[maxAreaIdx], hullIndices, defects);
-
-            int deepDefectCount = 0;
-            for (const cv::Vec4i &v : defects) {
-                float depth = v[3] / 256.0;
-                if (depth > 20) { 
-                    deepDefectCount++;
-                }
-            }
-
-            if (deepDefectCount <= 1) {
-                return true;
-            }
-        }
+  const double seconds = elapsedMs(start) / 1000.0;
+  std::cout << "Procesados " << frames << " fotogramas en " << seconds << " s ("
+            << (seconds > 0 ? frames / seconds : 0.0) << " fps), pose en " << posesFound << std::endl;
+  ResourceTracker::instance().printReport();
+  numa.printReport();
+}
+
+bool AugmentedRealityApp::openOutputs() {
+  if (!config.recordPath.empty()) {
+    recorder = std::make_unique<MjpegRecorder>(fileWriter, config.recordPath, 85, config.directIo);
+    if (!recorder->isOpened()) return false;
+  }
+  if (!config.poseLogPath.empty()) {
+    poseLog = std::make_unique<PoseLog>(fileWriter, config.poseLogPath);
+    if (!poseLog->isOpened()) return false;
+  }
+  if (recorder || poseLog)
+    std::cout << "Escritura a disco con " << fileWriter.backendName() << " ("
+              << fileWriter.bufferBytes() / 1024 << " KB de búferes)" << std::endl;
+  return true;
+}
+
+// Se llama desde un solo hilo por modo (el de trabajo o el de GLFW), como exige
+// cada flujo del AsyncFileWriter.
+void AugmentedRealityApp::recordFrame(const cv::Mat &frame, bool found, const cv::Vec3d &rvec,
+                                      const cv::Vec3d &tvec) {
+  if (poseLog) {
+    const long long timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    poseLog->write(recordedFrames, timestampUs, found, rvec, tvec);
+  }
+  if (recorder)
+    recorder->write(frame);
+  recordedFrames++;
+}
+
+// Recorre las tres configuraciones con una fuente sintética que estampa la hora
+// de captura en cada fotograma y publica un histograma de latencia por cada una.
+void AugmentedRealityApp::runLatencyTest() {
+  const cv::Size frameSize(640, 480);
+  source = std::make_unique<TimestampFrameSource>(frameSize, dictionary);
+  if (!isCalibrated)
+    useApproximateIntrinsics(frameSize);
+
+  if (!renderer.init(frameSize.width, frameSize.height, "Prueba de latencia AR")) {
+    std::cerr << "Fallo al inicializar el renderizador de OpenGL." << std::endl;
+    return;
+  }
+  renderer.setModelRenderScale(config.modelRenderScale);
+  renderer.setCompositeMode(config.compositeMode);
+  renderer.setFramePacing(config.pacing);
+  if (!renderer.loadModel(modelPath, modelMtlBasePath)) {
+    std::cerr << "Fallo al cargar el modelo 3D. Saliendo." << std::endl;
+    return;
+  }
+
+  const long long frames = config.latencyTestFrames;
+  LatencyProbe serial, pipelined, latest;
+  runSerial(frames, &serial);
+  runPipelined(false, frames, &pipelined);
+  runPipelined(true, frames, &latest);
+
+  serial.print("serial");
+  pipelined.print("pipelined");
+  latest.print("latest-frame-wins");
+
+  // Cada modo de presentación con el último gana, los fotogramas en vuelo y el late
+  // latch de la línea de comandos: latencia y jitter de cada uno.
+  for (PacingMode mode : {PacingMode::VSync, PacingMode::Adaptive, PacingMode::Uncapped, PacingMode::FixedRate}) {
+    FramePacer::Options pacing = config.pacing;
+    pacing.mode = mode;
+    renderer.setFramePacing(pacing);
+    LatencyProbe probe;
+    runPipelined(true, frames, &probe);
+    probe.print(std::string("latest-frame-wins, ") + FramePacer::modeName(mode));
+    renderer.printPacingReport();
+  }
+  renderer.setFramePacing(config.pacing);
+  renderer.printReport();
+}
+
+// Ejecuta y muestra el fotograma; si no cambió nada solo atiende los eventos.
+void AugmentedRealityApp::presentFrame(FramePacket &packet, LatencyProbe *probe) {
+  const bool drawn = renderer.execute(packet.frame, packet.commands);
+  if (drawn) {
+    if (probe) probe->captureBeforeSwap(renderer.getFramebufferSize(), packet.frame.size());
+    renderer.pollEventsAndSwapBuffers();
+    if (probe) probe->recordAfterSwap();
+  } else {
+    renderer.pollEvents();
+  }
+  idleGovernor.frameRendered(drawn);
+}
+
+void AugmentedRealityApp::runSerial(long long maxFrames, LatencyProbe *probe) {
+  FramePacket packet;
+  for (long long n = 0; !renderer.windowShouldClose() && (maxFrames == 0 || n < maxFrames); ++n) {
+    renderer.beginFrame();
+    idleGovernor.throttleCapture();
+    if (!source->read(packet.frame)) break;
+    packet.trackFrame();
+
+    detectAndBuild(packet);
+    presentFrame(packet, probe);
+    if (n == 0)
+      startupTrace.finish(fileWriter);
+    checkModelSwap();
+    if (ResourceTracker::instance().consumeDumpRequest())
+      ResourceTracker::instance().printReport();
+  }
+  sampleFrameResidency(packet.frame);
+}
+
+// Dónde quedaron las páginas de un fotograma del pool (métricas de --numa-node).
+void AugmentedRealityApp::sampleFrameResidency(const cv::Mat &frame) {
+  if (!frame.empty())
+    numa.sampleResidency("fotogramas", frame.data, frame.total() * frame.elemSize());
+}
+
+// Tecla M: cambia en caliente al siguiente modelo de --swap-model (y de vuelta al
+// original). El render sigue con el modelo actual mientras el nuevo se prepara.
+// Con --assets no hay modelo único que cambiar.
+void AugmentedRealityApp::checkModelSwap() {
+  if (!renderer.consumeKeyPress('M') || config.swapModelPaths.empty() || assets)
+    return;
+  const size_t next = (currentModel + 1) % (config.swapModelPaths.size() + 1);
+  const std::string objPath = next == 0 ? modelPath : config.swapModelPaths[next - 1];
+  const std::string directory = std::filesystem::path(objPath).parent_path().string();
+  const std::string mtlBasePath = next == 0 ? modelMtlBasePath : directory.empty() ? "" : directory + "/";
+  if (renderer.requestModelSwap(objPath, mtlBasePath))
+    currentModel = next;
+}
+
+// El hilo de trabajo captura, detecta y graba los comandos del fotograma N+1
+// mientras el hilo de GLFW ejecuta el N, sondea eventos e intercambia buffers.
+// Los paquetes se reciclan entre ambos hilos para no reservar memoria por fotograma.
+// Con latestFrameWins el hilo de trabajo captura al ritmo de la cámara y reemplaza
+// el paquete listo que GLFW no alcanzó a consumir, que pasa a reutilizarse.
+void AugmentedRealityApp::runPipelined(bool latestFrameWins, long long maxFrames, LatencyProbe *probe) {
+  const size_t packetCount = latestFrameWins ? 3 : 2;
+  FrameChannel<std::unique_ptr<FramePacket>> freePackets(packetCount);
+  FrameChannel<std::unique_ptr<FramePacket>> readyPackets(latestFrameWins ? 1 : packetCount);
+  for (size_t i = 0; i < packetCount; ++i)
+    freePackets.push(std::make_unique<FramePacket>());
+
+  long long droppedFrames = 0;
+  std::thread worker([&] {
+    std::unique_ptr<FramePacket> packet;
+    while (packet || freePackets.pop(packet)) {
+      idleGovernor.throttleCapture();
+      if (!source->read(packet->frame)) break;
+      packet->trackFrame();
+      detectAndBuild(*packet);
+      if (latestFrameWins) {
+        std::unique_ptr<FramePacket> stale;
+        if (!readyPackets.pushLatest(std::move(packet), stale)) break;
+        packet = std::move(stale);
+        if (packet) droppedFrames++;
+      } else if (!readyPackets.push(std::move(packet))) {
+        break;
+      }
     }
-    return false;
+    readyPackets.close();
+  });
+
+  // beginFrame() antes de tomar el paquete: con late latch y el último gana, se dibuja
+  // el fotograma más reciente que aún llega al refresco.
+  std::unique_ptr<FramePacket> packet;
+  for (long long n = 0; !renderer.windowShouldClose() && (maxFrames == 0 || n < maxFrames); ++n) {
+    renderer.beginFrame();
+    if (!readyPackets.pop(packet))
+      break;
+    presentFrame(*packet, probe);
+    if (n == 0)
+      startupTrace.finish(fileWriter);
+    checkModelSwap();
+    if (ResourceTracker::instance().consumeDumpRequest())
+      ResourceTracker::instance().printReport();
+    freePackets.push(std::move(packet));
+  }
+
+  freePackets.close();
+  readyPackets.close();
+  worker.join();
+  // Tras close() los canales aún devuelven lo pendiente: se recorre todo el pool.
+  do {
+    if (packet)
+      sampleFrameResidency(packet->frame);
+  } while (freePackets.tryPop(packet) || readyPackets.tryPop(packet));
+  if (droppedFrames)
+    std::cout << "Fotogramas descartados (el último gana): " << droppedFrames << std::endl;
 }
 
-int main() {
+int main(int argc, char **argv) {
+  AppConfig config;
+  if (!config.parse(argc, argv))
+    return config.helpRequested ? 0 : -1;
+
+  // `kill -USR1 <pid>` imprime el uso de memoria sin detener la aplicación.
+  ResourceTracker::installDumpSignal();
+
+  // Antes de crear la aplicación: todos sus hilos (escritura a disco, decodificación,
+  // carga de modelos, el de trabajo) heredan la afinidad y la política de memoria.
+  NumaPlacement numa(config.numaNode);
+  numa.bindCurrentThread("principal");
+
   try {
-    AugmentedRealityApp app;
+    AugmentedRealityApp app(config, numa);
     app.run();
   } catch (const cv::Exception &e) {
     std::cerr << "Error de OpenCV: " << e.what() << std::endl;